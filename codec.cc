@@ -0,0 +1,471 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "codec.hh"
+
+#include "codecbackends.hh"
+
+#define ZLIB_CONST
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+using std::optional;
+using std::string;
+using std::string_view;
+using std::vector;
+
+using namespace std::literals::string_view_literals;
+
+namespace {
+    // In order of preference, with the names used to select them.
+    constexpr std::array<std::pair<CodecBackend, string_view>, 3> const
+            BackendNames{
+                    {{CodecBackend::eLibdeflate, "libdeflate"sv},
+                     {CodecBackend::eZlibNg, "zlib-ng"sv},
+                     {CodecBackend::eZlib, "zlib"sv}}};
+
+    constexpr auto isBuiltIn(CodecBackend backend) noexcept -> bool {
+        switch (backend) {
+        case CodecBackend::eZlib:
+            return true;
+        case CodecBackend::eZlibNg:
+#ifdef SORCERYOBB_HAVE_ZLIB_NG
+            return true;
+#else
+            return false;
+#endif
+        case CodecBackend::eLibdeflate:
+#ifdef SORCERYOBB_HAVE_LIBDEFLATE
+            return true;
+#else
+            return false;
+#endif
+        }
+        return false;
+    }
+
+    constexpr auto fastestBackend() noexcept -> CodecBackend {
+        for (auto const& [backend, name] : BackendNames) {
+            if (isBuiltIn(backend)) {
+                return backend;
+            }
+        }
+        return CodecBackend::eZlib;
+    }
+
+    std::atomic<CodecBackend> selectedBackend{fastestBackend()};
+
+    auto inflateZlib(string_view compressed, char* output, size_t length)
+            -> InflateStatus {
+        // zlib needs somewhere to write even when nothing is expected, so that
+        // trailing garbage still shows up as a size mismatch.
+        std::array<char, 1> dummy{};
+        if (length == 0) {
+            output = dummy.data();
+        }
+        z_stream strm{};
+        if (inflateInit(&strm) != Z_OK) {
+            return InflateStatus::eDATA_ERROR;
+        }
+        strm.next_in   = reinterpret_cast<Bytef const*>(compressed.data());
+        strm.avail_in  = static_cast<uInt>(compressed.size());
+        strm.next_out  = reinterpret_cast<Bytef*>(output);
+        strm.avail_out = static_cast<uInt>(length == 0 ? dummy.size() : length);
+        int const    result = inflate(&strm, Z_FINISH);
+        size_t const total  = strm.total_out;
+        inflateEnd(&strm);
+        if (result == Z_STREAM_END) {
+            return total == length ? InflateStatus::eOK
+                                   : InflateStatus::eSIZE_MISMATCH;
+        }
+        if (result == Z_BUF_ERROR && strm.avail_out == 0) {
+            return InflateStatus::eSIZE_MISMATCH;
+        }
+        return InflateStatus::eDATA_ERROR;
+    }
+
+    auto deflateZlib(string_view data, int level) -> string {
+        uLongf length = compressBound(data.size());
+        string result(length, '\0');
+        if (compress2(
+                    reinterpret_cast<Bytef*>(result.data()), &length,
+                    reinterpret_cast<Bytef const*>(data.data()), data.size(),
+                    level)
+            != Z_OK) {
+            throw std::runtime_error("Could not compress data!");
+        }
+        result.resize(length);
+        return result;
+    }
+}    // namespace
+
+auto findCodecBackend(string_view name) -> optional<CodecBackend> {
+    for (auto const& [backend, backendName] : BackendNames) {
+        if (name == backendName && isBuiltIn(backend)) {
+            return backend;
+        }
+    }
+    return std::nullopt;
+}
+
+auto codecBackendName(CodecBackend backend) noexcept -> string_view {
+    for (auto const& [other, name] : BackendNames) {
+        if (other == backend) {
+            return name;
+        }
+    }
+    return {};
+}
+
+auto codecBackendNames() -> string {
+    string result;
+    for (auto const& [backend, name] : BackendNames) {
+        if (isBuiltIn(backend)) {
+            if (!result.empty()) {
+                result += ", "sv;
+            }
+            result += name;
+        }
+    }
+    return result;
+}
+
+auto codecBackend() noexcept -> CodecBackend {
+    return selectedBackend.load(std::memory_order_relaxed);
+}
+
+void setCodecBackend(CodecBackend backend) noexcept {
+    selectedBackend.store(backend, std::memory_order_relaxed);
+}
+
+auto inflateInto(string_view compressed, char* output, size_t length)
+        -> InflateStatus {
+    switch (codecBackend()) {
+#ifdef SORCERYOBB_HAVE_ZLIB_NG
+    case CodecBackend::eZlibNg:
+        return inflateZlibNg(compressed, output, length);
+#endif
+#ifdef SORCERYOBB_HAVE_LIBDEFLATE
+    case CodecBackend::eLibdeflate:
+        return inflateLibdeflate(compressed, output, length);
+#endif
+    default:
+        return inflateZlib(compressed, output, length);
+    }
+}
+
+auto deflateInto(string_view data, int level, CodecBackend backend)
+        -> string {
+    switch (backend) {
+#ifdef SORCERYOBB_HAVE_ZLIB_NG
+    case CodecBackend::eZlibNg:
+        return deflateZlibNg(data, level);
+#endif
+#ifdef SORCERYOBB_HAVE_LIBDEFLATE
+    case CodecBackend::eLibdeflate:
+        return deflateLibdeflate(data, level);
+#endif
+    default:
+        return deflateZlib(data, level);
+    }
+}
+
+namespace {
+    constexpr size_t const WindowSize = InflateCheckpoint::WindowSize;
+
+    // Keeps the last WindowSize bytes of output, and takes a checkpoint at
+    // the first block boundary at least span bytes after the previous one.
+    class CheckpointRecorder {
+    public:
+        explicit CheckpointRecorder(size_t _span)
+                : span(_span), window(WindowSize, '\0') {}
+
+        void update(
+                Bytef const* output, size_t written, z_stream const& strm,
+                size_t total, size_t length) {
+            if (written >= WindowSize) {
+                output += written - WindowSize;
+                written = WindowSize;
+            }
+            size_t const head = std::min(written, WindowSize - position);
+            std::copy_n(output, head, window.begin() + ptrdiff(position));
+            std::copy_n(output + head, written - head, window.begin());
+            position = (position + written) % WindowSize;
+            // Bit 7 of data_type is set at the end of a block, and bit 6 if
+            // it was the last one; only the former can be resumed from.
+            constexpr int const EndOfBlock = 128;
+            constexpr int const LastBlock  = 64;
+            constexpr int const UnusedBits = 7;
+            if ((strm.data_type & EndOfBlock) == 0
+                || (strm.data_type & LastBlock) != 0 || total < WindowSize
+                || total - last < span || total >= length) {
+                return;
+            }
+            InflateCheckpoint point;
+            point.outOffset = static_cast<uint32_t>(total);
+            point.inOffset  = static_cast<uint32_t>(strm.total_in);
+            point.bits = static_cast<uint8_t>(strm.data_type & UnusedBits);
+            point.window.reserve(WindowSize);
+            point.window.append(window, position, string::npos);
+            point.window.append(window, 0, position);
+            points.push_back(std::move(point));
+            last = total;
+        }
+
+        [[nodiscard]] auto take() -> vector<InflateCheckpoint> {
+            return std::move(points);
+        }
+
+    private:
+        static auto ptrdiff(size_t value) noexcept -> std::ptrdiff_t {
+            return static_cast<std::ptrdiff_t>(value);
+        }
+
+        size_t                    span;
+        size_t                    last     = 0;
+        size_t                    position = 0;
+        string                    window;
+        vector<InflateCheckpoint> points;
+    };
+}    // namespace
+
+struct InflateStream::State {
+    z_stream                          strm{};
+    size_t                            length = 0;
+    size_t                            total  = 0;
+    bool                              ended  = false;
+    InflateStatus                     status = InflateStatus::eOK;
+    std::optional<CheckpointRecorder> recorder;
+};
+
+InflateStream::InflateStream(string_view compressed, size_t length)
+        : state(std::make_unique<State>()) {
+    state->length = length;
+    if (inflateInit(&state->strm) != Z_OK) {
+        // Nothing to clean up in this case.
+        state.reset();
+        return;
+    }
+    state->strm.next_in  = reinterpret_cast<Bytef const*>(compressed.data());
+    state->strm.avail_in = static_cast<uInt>(compressed.size());
+}
+
+InflateStream::InflateStream(InflateStream&& other) noexcept = default;
+
+auto InflateStream::operator=(InflateStream&& other) noexcept
+        -> InflateStream& {
+    if (this != &other) {
+        if (state) {
+            inflateEnd(&state->strm);
+        }
+        state = std::move(other.state);
+    }
+    return *this;
+}
+
+InflateStream::~InflateStream() noexcept {
+    if (state) {
+        inflateEnd(&state->strm);
+    }
+}
+
+auto InflateStream::read(char* output, size_t length, size_t& produced)
+        -> InflateStatus {
+    produced = 0;
+    if (!state) {
+        return InflateStatus::eDATA_ERROR;
+    }
+    if (state->status != InflateStatus::eOK || state->ended) {
+        return state->status;
+    }
+    // As in inflateInto, zlib is given a byte to spare once everything was
+    // produced, so that it reaches the end of the stream or shows that there
+    // is more data than expected.
+    size_t const remaining = state->length - state->total;
+    if (length == 0 && remaining != 0) {
+        return state->status;
+    }
+    std::array<char, 1> dummy{};
+    length             = std::min(length, remaining);
+    bool const probing = length == 0;
+    if (probing) {
+        output = dummy.data();
+        length = dummy.size();
+    }
+    z_stream& strm = state->strm;
+    strm.next_out  = reinterpret_cast<Bytef*>(output);
+    strm.avail_out = static_cast<uInt>(length);
+    int result = Z_OK;
+    if (state->recorder && !probing) {
+        // Stops at the end of each block to see whether it is time for a
+        // checkpoint, but still fills as much of the output as it can.
+        do {
+            Bytef const* const before = strm.next_out;
+            result                    = inflate(&strm, Z_BLOCK);
+            size_t const step = static_cast<size_t>(strm.next_out - before);
+            state->recorder->update(
+                    before, step, strm, state->total + length - strm.avail_out,
+                    state->length);
+        } while (result == Z_OK && strm.avail_out != 0 && strm.avail_in != 0);
+    } else {
+        result = inflate(&strm, Z_NO_FLUSH);
+    }
+    size_t const written = length - strm.avail_out;
+    if (probing && written != 0) {
+        state->status = InflateStatus::eSIZE_MISMATCH;
+        return state->status;
+    }
+    if (!probing) {
+        produced = written;
+        state->total += written;
+    }
+    if (result == Z_STREAM_END) {
+        state->ended  = true;
+        state->status = state->total == state->length
+                                ? InflateStatus::eOK
+                                : InflateStatus::eSIZE_MISMATCH;
+    } else if (
+            (result != Z_OK && result != Z_BUF_ERROR)
+            || (written == 0 && strm.avail_in == 0)) {
+        // Either bad data, or the input ended before the stream did.
+        state->status = InflateStatus::eDATA_ERROR;
+    }
+    return state->status;
+}
+
+auto InflateStream::finished() const noexcept -> bool {
+    return state && state->ended && state->status == InflateStatus::eOK;
+}
+
+void InflateStream::recordCheckpoints(size_t span) {
+    if (state) {
+        state->recorder.emplace(span);
+    }
+}
+
+auto InflateStream::takeCheckpoints() -> vector<InflateCheckpoint> {
+    if (!state || !state->recorder) {
+        return {};
+    }
+    return state->recorder->take();
+}
+
+auto inflateIndexed(
+        string_view compressed, char* output, size_t length, size_t span,
+        vector<InflateCheckpoint>& checkpoints) -> InflateStatus {
+    InflateStream stream(compressed, length);
+    stream.recordCheckpoints(span);
+    size_t        done   = 0;
+    InflateStatus status = InflateStatus::eOK;
+    while (status == InflateStatus::eOK && !stream.finished()) {
+        size_t produced = 0;
+        status = stream.read(output + done, length - done, produced);
+        done += produced;
+    }
+    checkpoints = stream.takeCheckpoints();
+    return status;
+}
+
+auto inflateRange(
+        string_view compressed, size_t length,
+        vector<InflateCheckpoint> const& checkpoints, size_t offset,
+        char* output, size_t count) -> InflateStatus {
+    if (offset > length || count > length - offset) {
+        return InflateStatus::eSIZE_MISMATCH;
+    }
+    auto const after = std::upper_bound(
+            checkpoints.cbegin(), checkpoints.cend(), offset,
+            [](size_t value, InflateCheckpoint const& point) {
+                return value < point.outOffset;
+            });
+    z_stream strm{};
+    size_t   position = 0;
+    if (after == checkpoints.cbegin()) {
+        if (inflateInit(&strm) != Z_OK) {
+            return InflateStatus::eDATA_ERROR;
+        }
+        strm.next_in  = reinterpret_cast<Bytef const*>(compressed.data());
+        strm.avail_in = static_cast<uInt>(compressed.size());
+    } else {
+        // The checkpoint is in the middle of the raw deflate data, so there
+        // is no zlib header to read there.
+        InflateCheckpoint const& point = *std::prev(after);
+        if (point.inOffset > compressed.size() || point.outOffset > length
+            || point.window.size() != WindowSize
+            || (point.bits != 0 && point.inOffset == 0) || point.bits > 7) {
+            return InflateStatus::eDATA_ERROR;
+        }
+        if (inflateInit2(&strm, -MAX_WBITS) != Z_OK) {
+            return InflateStatus::eDATA_ERROR;
+        }
+        int result = Z_OK;
+        if (point.bits != 0) {
+            auto const byte = static_cast<unsigned char>(
+                    compressed[point.inOffset - 1]);
+            result = inflatePrime(
+                    &strm, point.bits, byte >> (8U - point.bits));
+        }
+        if (result == Z_OK) {
+            result = inflateSetDictionary(
+                    &strm,
+                    reinterpret_cast<Bytef const*>(point.window.data()),
+                    static_cast<uInt>(point.window.size()));
+        }
+        if (result != Z_OK) {
+            inflateEnd(&strm);
+            return InflateStatus::eDATA_ERROR;
+        }
+        strm.next_in = reinterpret_cast<Bytef const*>(
+                compressed.data() + point.inOffset);
+        strm.avail_in = static_cast<uInt>(compressed.size() - point.inOffset);
+        position      = point.outOffset;
+    }
+    // Output before the range is inflated into scratch space and dropped.
+    std::array<char, WindowSize> scratch{};
+    int                          result = Z_OK;
+    size_t                       done   = 0;
+    while (done < count && result == Z_OK) {
+        bool const skipping = position < offset;
+        size_t const wanted = skipping ? std::min(offset - position, WindowSize)
+                                       : count - done;
+        char* const target  = skipping ? scratch.data() : output + done;
+        strm.next_out       = reinterpret_cast<Bytef*>(target);
+        strm.avail_out      = static_cast<uInt>(wanted);
+        result              = inflate(&strm, Z_NO_FLUSH);
+        size_t const written = wanted - strm.avail_out;
+        if (skipping) {
+            position += written;
+        } else {
+            done += written;
+        }
+        if (written == 0 && result == Z_OK) {
+            result = Z_BUF_ERROR;
+        }
+    }
+    inflateEnd(&strm);
+    if (done == count) {
+        return InflateStatus::eOK;
+    }
+    return result == Z_STREAM_END ? InflateStatus::eSIZE_MISMATCH
+                                  : InflateStatus::eDATA_ERROR;
+}
@@ -0,0 +1,122 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class InflateStatus { eOK, eSIZE_MISMATCH, eDATA_ERROR };
+
+// Implementations of inflateInto and deflateInto. zlib is always built in;
+// zlib-ng and libdeflate are faster, and are built in when the Makefile can
+// link with them. All of them read and write standard zlib streams. The
+// streaming and checkpoint functions below always use zlib.
+enum class CodecBackend { eZlib, eZlibNg, eLibdeflate };
+
+// The backend called name ("zlib", "zlib-ng" or "libdeflate"), if built in.
+[[nodiscard]] __attribute__((pure)) auto findCodecBackend(
+        std::string_view name) -> std::optional<CodecBackend>;
+[[nodiscard]] __attribute__((pure)) auto codecBackendName(
+        CodecBackend backend) noexcept -> std::string_view;
+// Names of the built-in backends, fastest first, separated by ", ".
+[[nodiscard]] auto codecBackendNames() -> std::string;
+// The backend inflateInto uses in all threads; the fastest built-in one unless
+// changed.
+[[nodiscard]] auto codecBackend() noexcept -> CodecBackend;
+// Must be built in.
+void setCodecBackend(CodecBackend backend) noexcept;
+
+// Inflates a complete zlib stream in a single call, straight into a buffer
+// which must be exactly as large as the inflated data. Output that does not
+// fill the buffer exactly, or that would overflow it, is reported as a size
+// mismatch.
+[[nodiscard]] auto inflateInto(
+        std::string_view compressed, char* output, size_t length)
+        -> InflateStatus;
+// Compresses data into a complete zlib stream, at a level from 0 to 9 as for
+// zlib. Backends produce different bytes, so this uses zlib unless another
+// backend is asked for, whatever codecBackend() is.
+[[nodiscard]] auto deflateInto(
+        std::string_view data, int level,
+        CodecBackend backend = CodecBackend::eZlib) -> std::string;
+
+// A point in a zlib stream from which inflating can resume without going
+// through everything before it, as in zlib's zran example: it starts at a
+// deflate block boundary, and carries the window the block may refer to.
+struct InflateCheckpoint {
+    static constexpr size_t const WindowSize = 32768;
+
+    // Position in the inflated data.
+    uint32_t outOffset = 0U;
+    // Position in the compressed data of the first byte which is not fully
+    // consumed; bits of the byte before it are still unused.
+    uint32_t inOffset = 0U;
+    uint8_t  bits     = 0U;
+    // The WindowSize bytes of inflated data before outOffset.
+    std::string window;
+};
+
+// Inflates a zlib stream a piece at a time, into buffers supplied by the
+// caller, checking that it inflates to exactly length bytes. The compressed
+// data must outlive the stream.
+class InflateStream {
+public:
+    InflateStream(std::string_view compressed, size_t length);
+    InflateStream(InflateStream&& other) noexcept;
+    auto operator=(InflateStream&& other) noexcept -> InflateStream&;
+    InflateStream(InflateStream const&) = delete;
+    auto operator=(InflateStream const&) -> InflateStream& = delete;
+    ~InflateStream() noexcept;
+
+    // Inflates up to length bytes into output, and sets produced to the
+    // amount written. Once all of the data has been produced, the next read
+    // checks that the stream ends there. Errors are sticky.
+    [[nodiscard]] auto read(char* output, size_t length, size_t& produced)
+            -> InflateStatus;
+    // True once the stream has ended with the expected length.
+    [[nodiscard]] __attribute__((pure)) auto finished() const noexcept
+            -> bool;
+    // Makes the stream record a checkpoint about every span bytes of output
+    // from now on, to be taken once it has finished.
+    void recordCheckpoints(size_t span);
+    [[nodiscard]] auto takeCheckpoints() -> std::vector<InflateCheckpoint>;
+
+private:
+    struct State;
+    std::unique_ptr<State> state;
+};
+
+// Like inflateInto, but also records a checkpoint about every span bytes of
+// output.
+[[nodiscard]] auto inflateIndexed(
+        std::string_view compressed, char* output, size_t length, size_t span,
+        std::vector<InflateCheckpoint>& checkpoints) -> InflateStatus;
+
+// Inflates count bytes starting at offset of a zlib stream that inflates to
+// length bytes, resuming from the last of the checkpoints (sorted by
+// position) before offset, if any. Ranges outside of the inflated data are
+// reported as a size mismatch.
+[[nodiscard]] auto inflateRange(
+        std::string_view compressed, size_t length,
+        std::vector<InflateCheckpoint> const& checkpoints, size_t offset,
+        char* output, size_t count) -> InflateStatus;
@@ -0,0 +1,130 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "codecbackends.hh"
+
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+
+#ifdef SORCERYOBB_HAVE_ZLIB_NG
+#    include <zlib-ng.h>
+#endif
+
+#ifdef SORCERYOBB_HAVE_LIBDEFLATE
+#    include <libdeflate.h>
+
+#    include <memory>
+#endif
+
+using std::string;
+using std::string_view;
+
+#ifdef SORCERYOBB_HAVE_ZLIB_NG
+auto inflateZlibNg(string_view compressed, char* output, size_t length)
+        -> InflateStatus {
+    size_t       produced = length;
+    size_t       consumed = compressed.size();
+    int32_t const result  = zng_uncompress2(
+            reinterpret_cast<uint8_t*>(output), &produced,
+            reinterpret_cast<uint8_t const*>(compressed.data()), &consumed);
+    if (result == Z_OK) {
+        return produced == length ? InflateStatus::eOK
+                                  : InflateStatus::eSIZE_MISMATCH;
+    }
+    // Only reported when the output is full; truncated input is a data
+    // error.
+    if (result == Z_BUF_ERROR) {
+        return InflateStatus::eSIZE_MISMATCH;
+    }
+    return InflateStatus::eDATA_ERROR;
+}
+
+auto deflateZlibNg(string_view data, int level) -> string {
+    size_t length = zng_compressBound(data.size());
+    string result(length, '\0');
+    if (zng_compress2(
+                reinterpret_cast<uint8_t*>(result.data()), &length,
+                reinterpret_cast<uint8_t const*>(data.data()), data.size(),
+                level)
+        != Z_OK) {
+        throw std::runtime_error("Could not compress data!");
+    }
+    result.resize(length);
+    return result;
+}
+#endif
+
+#ifdef SORCERYOBB_HAVE_LIBDEFLATE
+namespace {
+    struct DecompressorDeleter {
+        void operator()(libdeflate_decompressor* decompressor) const noexcept {
+            libdeflate_free_decompressor(decompressor);
+        }
+    };
+
+    struct CompressorDeleter {
+        void operator()(libdeflate_compressor* compressor) const noexcept {
+            libdeflate_free_compressor(compressor);
+        }
+    };
+}    // namespace
+
+auto inflateLibdeflate(string_view compressed, char* output, size_t length)
+        -> InflateStatus {
+    // Reused by all entries a thread inflates.
+    thread_local std::unique_ptr<
+            libdeflate_decompressor, DecompressorDeleter> const decompressor(
+            libdeflate_alloc_decompressor());
+    if (!decompressor) {
+        throw std::bad_alloc();
+    }
+    // Without a place for the actual size, output which does not fill the
+    // buffer exactly is reported as short.
+    switch (libdeflate_zlib_decompress(
+            decompressor.get(), compressed.data(), compressed.size(), output,
+            length, nullptr)) {
+    case LIBDEFLATE_SUCCESS:
+        return InflateStatus::eOK;
+    case LIBDEFLATE_SHORT_OUTPUT:
+    case LIBDEFLATE_INSUFFICIENT_SPACE:
+        return InflateStatus::eSIZE_MISMATCH;
+    default:
+        return InflateStatus::eDATA_ERROR;
+    }
+}
+
+auto deflateLibdeflate(string_view data, int level) -> string {
+    std::unique_ptr<libdeflate_compressor, CompressorDeleter> const compressor(
+            libdeflate_alloc_compressor(level));
+    if (!compressor) {
+        throw std::bad_alloc();
+    }
+    string result(
+            libdeflate_zlib_compress_bound(compressor.get(), data.size()),
+            '\0');
+    size_t const length = libdeflate_zlib_compress(
+            compressor.get(), data.data(), data.size(), result.data(),
+            result.size());
+    // Cannot happen, as the output has room for the bound.
+    if (length == 0) {
+        throw std::runtime_error("Could not compress data!");
+    }
+    result.resize(length);
+    return result;
+}
+#endif
@@ -0,0 +1,44 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Whole-buffer inflate and deflate through the optional backends of codec.hh;
+// each is only declared when it is built in. They live apart from the zlib
+// code, as the header of zlib-ng clashes with that of zlib.
+
+#include "codec.hh"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#ifdef SORCERYOBB_HAVE_ZLIB_NG
+[[nodiscard]] auto inflateZlibNg(
+        std::string_view compressed, char* output, size_t length)
+        -> InflateStatus;
+[[nodiscard]] auto deflateZlibNg(std::string_view data, int level)
+        -> std::string;
+#endif
+
+#ifdef SORCERYOBB_HAVE_LIBDEFLATE
+[[nodiscard]] auto inflateLibdeflate(
+        std::string_view compressed, char* output, size_t length)
+        -> InflateStatus;
+[[nodiscard]] auto deflateLibdeflate(std::string_view data, int level)
+        -> std::string;
+#endif
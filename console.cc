@@ -0,0 +1,68 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "console.hh"
+
+#include <utility>
+
+using std::lock_guard;
+using std::mutex;
+using std::string;
+using std::unique_lock;
+
+Console::Console(std::ostream& _out) : out(_out), display([this] { run(); }) {}
+
+Console::~Console() noexcept {
+    {
+        lock_guard<mutex> lock(console_mutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    display.join();
+}
+
+void Console::setProgress(string message) {
+    bool wasDirty = false;
+    {
+        lock_guard<mutex> lock(console_mutex);
+        pending  = std::move(message);
+        wasDirty = std::exchange(dirty, true);
+    }
+    if (!wasDirty) {
+        wakeup.notify_one();
+    }
+}
+
+void Console::showProgress() {
+    if (dirty) {
+        out << "\33[2K\r" << pending << std::flush;
+        dirty = false;
+    }
+}
+
+void Console::run() {
+    unique_lock<mutex> lock(console_mutex);
+    while (true) {
+        wakeup.wait(lock, [this] { return dirty || stopping; });
+        if (stopping) {
+            return;
+        }
+        showProgress();
+        // Further messages wait for the end of the interval.
+        wakeup.wait_for(lock, Interval, [this] { return stopping; });
+    }
+}
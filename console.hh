@@ -0,0 +1,91 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Serializes console output from worker threads, so that progress and error
+// messages from different threads do not get interleaved. Progress goes to
+// stderr instead of stdout when stdout carries extracted data.
+//
+// Progress messages only replace the pending one; a background thread shows
+// the latest of them at most once per Interval, so that workers do not wait on
+// the terminal for every file. Everything else is written right away.
+class Console {
+public:
+    static constexpr std::chrono::milliseconds const Interval{100};
+
+    explicit Console(std::ostream& _out);
+    Console(Console const&) = delete;
+    Console(Console&&)      = delete;
+    auto operator=(Console const&) -> Console& = delete;
+    auto operator=(Console&&) -> Console& = delete;
+    // Pending progress that was never shown is dropped.
+    ~Console() noexcept;
+
+    template <typename... Args>
+    void progress(Args const&... args) {
+        std::ostringstream message;
+        (message << ... << args);
+        setProgress(message.str());
+    }
+
+    template <typename... Args>
+    void line(Args const&... args) {
+        std::lock_guard<std::mutex> lock(console_mutex);
+        dirty = false;
+        ((out << "\33[2K\r") << ... << args) << std::endl;
+    }
+
+    // Continues the current line, showing any pending progress first.
+    template <typename... Args>
+    void append(Args const&... args) {
+        std::lock_guard<std::mutex> lock(console_mutex);
+        showProgress();
+        (out << ... << args) << std::flush;
+    }
+
+    template <typename... Args>
+    void error(Args const&... args) {
+        std::lock_guard<std::mutex> lock(console_mutex);
+        dirty = false;
+        out << "\33[2K\r" << std::flush;
+        (std::cerr << ... << args) << std::endl;
+    }
+
+private:
+    void setProgress(std::string message);
+    // Must be called with console_mutex held.
+    void showProgress();
+    void run();
+
+    std::ostream&           out;
+    std::mutex              console_mutex;
+    std::condition_variable wakeup;
+    std::string             pending;
+    bool                    dirty    = false;
+    bool                    stopping = false;
+    std::thread             display;
+};
@@ -0,0 +1,85 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "eventlog.hh"
+
+#include "jsonstring.hh"
+
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+using std::lock_guard;
+using std::mutex;
+using std::string;
+using std::string_view;
+
+using namespace std::literals::string_view_literals;
+
+using boost::filesystem::path;
+namespace io = boost::iostreams;
+
+auto EventLog::open(string_view spec) -> std::unique_ptr<EventLog> {
+    string const  name(spec);
+    char*         last = nullptr;
+    unsigned long fd   = std::strtoul(name.c_str(), &last, 10);
+    try {
+        if (!name.empty() && *last == '\0') {
+            io::file_descriptor_sink sink(
+                    static_cast<int>(fd), io::never_close_handle);
+            if (!sink.is_open()) {
+                return nullptr;
+            }
+            return std::unique_ptr<EventLog>(new EventLog(sink));
+        }
+        io::file_descriptor_sink sink(name, std::ios::out | std::ios::trunc);
+        if (!sink.is_open()) {
+            return nullptr;
+        }
+        return std::unique_ptr<EventLog>(new EventLog(sink));
+    } catch (std::ios_base::failure const&) {
+        return nullptr;
+    }
+}
+
+void EventLog::file(string_view status, string_view name, path const& outfile) {
+    std::ostringstream line;
+    line << R"({"event":"file","status":)";
+    printJsonString(line, status);
+    line << R"(,"name":)";
+    printJsonString(line, name);
+    line << R"(,"path":)";
+    printJsonString(line, outfile.string());
+    line << "}\n"sv;
+    write(line.str());
+}
+
+void EventLog::done(path const& obbfile, path const& outdir) {
+    std::ostringstream line;
+    line << R"({"event":"done","obb":)";
+    printJsonString(line, obbfile.string());
+    line << R"(,"path":)";
+    printJsonString(line, outdir.string());
+    line << "}\n"sv;
+    write(line.str());
+}
+
+void EventLog::write(string const& line) {
+    lock_guard<mutex> lock(eventMutex);
+    out << line;
+    out.flush();
+}
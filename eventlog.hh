@@ -0,0 +1,57 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// Reports each file as soon as it is done, as one JSON object per line, so
+// that other programs can start on the files they want while extraction goes
+// on. Each line is written and flushed whole. Thread-safe.
+class EventLog {
+public:
+    // spec is the number of an open file descriptor, or the path of a file or
+    // named pipe to write to. Returns nothing if it cannot be opened.
+    [[nodiscard]] static auto open(std::string_view spec)
+            -> std::unique_ptr<EventLog>;
+
+    // status says what happened to the file: "written", "linked",
+    // "unchanged" or "failed".
+    void file(
+            std::string_view status, std::string_view name,
+            boost::filesystem::path const& outfile);
+    // All files of obbfile are done, and so is its output directory.
+    void done(
+            boost::filesystem::path const& obbfile,
+            boost::filesystem::path const& outdir);
+
+private:
+    explicit EventLog(boost::iostreams::file_descriptor_sink sink)
+            : out(sink) {}
+
+    void write(std::string const& line);
+
+    boost::iostreams::stream<boost::iostreams::file_descriptor_sink> out;
+    std::mutex eventMutex;
+};
@@ -23,6 +23,7 @@
 #include <boost/archive/text_oarchive.hpp>
 
 #include <string_view>
+#include <utility>
 
 struct File_data {
     uint32_t offset     = 0U;
@@ -51,6 +52,10 @@ struct Basic_File_entry {
             : fname(getData(position, oggview)), fdata(getData(position, oggview)),
               compressed(fdata.size() != Read4(position)) {
     }
+    Basic_File_entry(
+            std::string_view _fname, FileDataT _fdata, bool _compressed)
+            : fname(_fname), fdata(std::move(_fdata)), compressed(_compressed) {
+    }
 
 private:
     friend class boost::serialization::access;
@@ -0,0 +1,127 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fileindex.hh"
+
+#include "endianio.hh"
+
+#include <algorithm>
+
+using std::runtime_error;
+using std::string;
+using std::string_view;
+using std::vector;
+
+using namespace std::literals::string_view_literals;
+
+namespace {
+    constexpr string_view const Signature      = "XOBBIDX\0"sv;
+    constexpr uint32_t const    CompressedFlag = 1U;
+    constexpr uint32_t const    ChecksumFlag   = 2U;
+
+    auto read8(char const*& ptr) -> uint64_t {
+        uint64_t const low  = Read4(ptr);
+        uint64_t const high = Read4(ptr);
+        return low | (high << 32U);
+    }
+
+    void write8(char*& ptr, uint64_t value) {
+        Write4(ptr, static_cast<uint32_t>(value));
+        Write4(ptr, static_cast<uint32_t>(value >> 32U));
+    }
+}    // namespace
+
+auto FileIndex::isIndex(string_view _data) noexcept -> bool {
+    return _data.substr(0, Signature.size()) == Signature;
+}
+
+FileIndex::FileIndex(string_view _data) : data(_data) {
+    if (data.size() < HeaderSize || !isIndex(data)) {
+        throw runtime_error("File table index is missing its signature!");
+    }
+    char const*    ptr        = data.data() + Signature.size();
+    uint32_t const version    = Read4(ptr);
+    uint32_t const count      = Read4(ptr);
+    uint32_t const nameOffset = Read4(ptr);
+    uint32_t const nameLength = Read4(ptr);
+    if (version != Version) {
+        throw runtime_error("Unsupported file table index version!");
+    }
+    if (count > (data.size() - HeaderSize) / RecordSize
+        || nameOffset < HeaderSize + count * RecordSize
+        || nameOffset > data.size()
+        || nameLength > data.size() - nameOffset) {
+        throw runtime_error("File table index is corrupt!");
+    }
+    numRecords = count;
+    names      = data.substr(nameOffset, nameLength);
+}
+
+auto FileIndex::operator[](size_t index) const -> Record {
+    char const*    ptr        = data.data() + HeaderSize + index * RecordSize;
+    uint32_t const nameOffset = Read4(ptr);
+    uint32_t const nameLength = Read4(ptr);
+    if (nameOffset > names.size() || nameLength > names.size() - nameOffset) {
+        throw runtime_error("File table index is corrupt!");
+    }
+    Record record;
+    record.name       = names.substr(nameOffset, nameLength);
+    record.offset     = Read4(ptr);
+    record.complength = Read4(ptr);
+    record.fulllength = Read4(ptr);
+    uint32_t const flags = Read4(ptr);
+    record.compressed    = (flags & CompressedFlag) != 0;
+    record.hasChecksum   = (flags & ChecksumFlag) != 0;
+    record.checksum      = read8(ptr);
+    return record;
+}
+
+auto FileIndex::format(vector<Record> const& records) -> string {
+    size_t nameLength = 0;
+    for (auto const& record : records) {
+        nameLength += record.name.size();
+    }
+    size_t const nameOffset = HeaderSize + records.size() * RecordSize;
+    string       result(nameOffset, '\0');
+    result.reserve(nameOffset + nameLength);
+
+    char* ptr = result.data();
+    std::copy(Signature.cbegin(), Signature.cend(), ptr);
+    ptr += Signature.size();
+    Write4(ptr, Version);
+    Write4(ptr, static_cast<uint32_t>(records.size()));
+    Write4(ptr, static_cast<uint32_t>(nameOffset));
+    Write4(ptr, static_cast<uint32_t>(nameLength));
+    ptr = result.data() + HeaderSize;
+    uint32_t currName = 0;
+    for (auto const& record : records) {
+        Write4(ptr, currName);
+        Write4(ptr, static_cast<uint32_t>(record.name.size()));
+        Write4(ptr, record.offset);
+        Write4(ptr, record.complength);
+        Write4(ptr, record.fulllength);
+        Write4(ptr,
+               (record.compressed ? CompressedFlag : 0U)
+                       | (record.hasChecksum ? ChecksumFlag : 0U));
+        write8(ptr, record.hasChecksum ? record.checksum : 0U);
+        currName += static_cast<uint32_t>(record.name.size());
+    }
+    for (auto const& record : records) {
+        result += record.name;
+    }
+    return result;
+}
@@ -0,0 +1,90 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Binary file table saved by xtractobb, and used by repackobb to rebuild the
+// OBB with the same layout. It is designed to be used straight from a memory
+// mapping: records have fixed size, and are only decoded when accessed.
+//
+// All integers are little endian. The file starts with a 32-byte header:
+//
+//     Offset  Length  Content
+//     0       8       "XOBBIDX" followed by a NUL
+//     8       4       Format version (FileIndex::Version)
+//     12      4       Number of records
+//     16      4       Offset of the name block
+//     20      4       Length of the name block
+//     24      8       Reserved, zero
+//
+// It is followed by the records, in the order the data was in the OBB, each
+// 32 bytes long:
+//
+//     0       4       Name offset, relative to the name block
+//     4       4       Name length
+//     8       4       Offset of the data in the OBB
+//     12      4       Compressed size
+//     16      4       Uncompressed size
+//     20      4       Flags; bit 0 is set for compressed entries, and bit 1
+//                     if the hash is present
+//     24      8       XXH64 hash of the data as stored in the OBB, or zero
+//
+// Hashes are only present for entries which were extracted, so that skipping
+// entries does not require reading their data.
+//
+// The name block has all names, without separators.
+class FileIndex {
+public:
+    static constexpr uint32_t const Version    = 1;
+    static constexpr size_t const   HeaderSize = 32;
+    static constexpr size_t const   RecordSize = 32;
+
+    struct Record {
+        std::string_view name;
+        uint32_t         offset      = 0U;
+        uint32_t         complength  = 0U;
+        uint32_t         fulllength  = 0U;
+        bool             compressed  = false;
+        bool             hasChecksum = false;
+        uint64_t         checksum    = 0U;
+    };
+
+    // True if data starts with the signature of an index (of any version).
+    [[nodiscard]] __attribute__((pure)) static auto isIndex(
+            std::string_view data) noexcept -> bool;
+    // Throws std::runtime_error if data is not a valid index.
+    explicit FileIndex(std::string_view _data);
+
+    [[nodiscard]] auto size() const noexcept -> size_t {
+        return numRecords;
+    }
+    [[nodiscard]] auto operator[](size_t index) const -> Record;
+
+    [[nodiscard]] static auto format(std::vector<Record> const& records)
+            -> std::string;
+
+private:
+    std::string_view data;
+    std::string_view names;
+    size_t           numRecords = 0;
+};
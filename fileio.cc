@@ -0,0 +1,516 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fileio.hh"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#ifdef XTRACTOBB_POSIX_IO
+#    include <boost/iostreams/device/file_descriptor.hpp>
+#    include <boost/iostreams/stream.hpp>
+
+#    include <cerrno>
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/resource.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+#ifdef __linux__
+#    include <linux/fs.h>
+#    include <sys/ioctl.h>
+#endif
+
+using std::string;
+using std::string_view;
+using std::unique_ptr;
+
+using boost::filesystem::path;
+
+void UniqueFd::reset(int _fd) noexcept {
+#ifdef XTRACTOBB_POSIX_IO
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#endif
+    fd = _fd;
+}
+
+auto openForReading(path const& fname) -> UniqueFd {
+#ifdef XTRACTOBB_POSIX_IO
+    return UniqueFd(::open(fname.c_str(), O_RDONLY | O_CLOEXEC));
+#else
+    static_cast<void>(fname);
+    return UniqueFd();
+#endif
+}
+
+auto writeFileIfChanged(path const& fname, string_view data) -> bool {
+    boost::system::error_code errcode;
+    if (file_size(fname, errcode) == data.size() && !errcode) {
+        boost::filesystem::ifstream fin(fname, std::ios::in | std::ios::binary);
+        std::vector<char>           contents(data.size());
+        fin.read(contents.data(), static_cast<std::streamsize>(data.size()));
+        if (fin.good()
+            && string_view(contents.data(), contents.size()) == data) {
+            return true;
+        }
+    }
+    path tempfile(fname);
+    tempfile += ".tmp";
+    {
+        boost::filesystem::ofstream fout(
+                tempfile, std::ios::out | std::ios::binary);
+        fout.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!fout.good()) {
+            return false;
+        }
+    }
+    rename(tempfile, fname, errcode);
+    return !errcode;
+}
+
+#ifdef XTRACTOBB_POSIX_IO
+namespace {
+    // Directories get a quarter of what is left of the descriptor limit after
+    // setting aside enough for the standard streams, the OBB, the files in
+    // flight, and so on. The budget is shared by all trees, as --batch keeps
+    // several of them open at once.
+    auto directoryBudget() noexcept -> std::atomic<size_t>& {
+        static std::atomic<size_t> budget = []() noexcept -> size_t {
+            constexpr rlim_t const ReservedFds = 64;
+            rlimit                 limit{};
+            if (::getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+                return 0;
+            }
+            if (limit.rlim_cur == RLIM_INFINITY) {
+                return SIZE_MAX;
+            }
+            return limit.rlim_cur > ReservedFds
+                           ? (limit.rlim_cur - ReservedFds) / 4
+                           : 0;
+        }();
+        return budget;
+    }
+
+    // Takes a directory descriptor from the budget; false if none are left.
+    auto takeDirectoryFd() noexcept -> bool {
+        std::atomic<size_t>& budget = directoryBudget();
+        size_t               left   = budget.load();
+        while (left > 0 && !budget.compare_exchange_weak(left, left - 1)) {
+        }
+        return left > 0;
+    }
+
+    void returnDirectoryFds(size_t count) noexcept {
+        directoryBudget() += count;
+    }
+
+    // Copies as much as the kernel is willing to copy between the files
+    // without going through user space; returns the number of bytes copied.
+    auto kernelCopy(
+            int srcfd, uint64_t srcOffset, int dstfd, size_t length) -> size_t {
+        size_t done = 0;
+#    ifdef __linux__
+        while (srcfd >= 0 && done < length) {
+            auto    offset = static_cast<loff_t>(srcOffset + done);
+            ssize_t copied = ::copy_file_range(
+                    srcfd, &offset, dstfd, nullptr, length - done, 0U);
+            if (copied < 0 && errno == EINTR) {
+                continue;
+            }
+            // Errors (such as EXDEV, ENOSYS or EOPNOTSUPP on older kernels
+            // or some filesystems) just mean the caller has to do the rest.
+            if (copied <= 0) {
+                break;
+            }
+            done += static_cast<size_t>(copied);
+        }
+#    else
+        static_cast<void>(srcfd);
+        static_cast<void>(srcOffset);
+        static_cast<void>(dstfd);
+        static_cast<void>(length);
+#    endif
+        return done;
+    }
+}    // namespace
+#endif
+
+OutputTree::OutputTree(path _root) : rootdir(std::move(_root)) {
+#ifdef XTRACTOBB_POSIX_IO
+    UniqueFd handle;
+    if (takeDirectoryFd()) {
+        handle = UniqueFd(
+                ::open(rootdir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        if (handle) {
+            heldFds++;
+        } else {
+            returnDirectoryFds(1);
+        }
+    }
+    directories.emplace(string(), std::move(handle));
+#else
+    directories.emplace(string(), UniqueFd());
+#endif
+}
+
+OutputTree::~OutputTree() noexcept {
+#ifdef XTRACTOBB_POSIX_IO
+    directories.clear();
+    returnDirectoryFds(heldFds);
+#endif
+}
+
+auto OutputTree::addDirectory(path const& dir) -> bool {
+    string const key = dir.generic_string();
+    if (directories.count(key) != 0) {
+        return true;
+    }
+    if (!addDirectory(dir.parent_path())) {
+        return false;
+    }
+#ifdef XTRACTOBB_POSIX_IO
+    UniqueFd const& parent = directories.at(dir.parent_path().generic_string());
+    if (parent && takeDirectoryFd()) {
+        string const leaf = dir.filename().string();
+        if (::mkdirat(parent.get(), leaf.c_str(), 0777) != 0
+            && errno != EEXIST) {
+            returnDirectoryFds(1);
+            return false;
+        }
+        UniqueFd handle(::openat(
+                parent.get(), leaf.c_str(),
+                O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        if (handle) {
+            directories.emplace(key, std::move(handle));
+            heldFds++;
+            return true;
+        }
+        returnDirectoryFds(1);
+        // Out of descriptors: this directory, and anything below it, are
+        // reached by path.
+        if (errno != EMFILE && errno != ENFILE) {
+            return false;
+        }
+    }
+#endif
+    boost::system::error_code errcode;
+    create_directories(rootdir / dir, errcode);
+    if (!is_directory(rootdir / dir, errcode)) {
+        return false;
+    }
+    directories.emplace(key, UniqueFd());
+    return true;
+}
+
+auto OutputTree::hasDirectory(path const& dir) const -> bool {
+    return directories.count(dir.generic_string()) != 0;
+}
+
+auto OutputTree::locate(path const& name, string& leaf) const -> int {
+#ifdef XTRACTOBB_POSIX_IO
+    auto const found = directories.find(name.parent_path().generic_string());
+    if (found != directories.cend() && found->second) {
+        leaf = name.filename().string();
+        return found->second.get();
+    }
+    leaf = (rootdir / name).string();
+    return AT_FDCWD;
+#else
+    leaf = (rootdir / name).string();
+    return -1;
+#endif
+}
+
+auto OutputTree::createFile(path const& name, bool readWrite) const
+        -> UniqueFd {
+#ifdef XTRACTOBB_POSIX_IO
+    string    leaf;
+    int const dirfd = locate(name, leaf);
+    return UniqueFd(::openat(
+            dirfd, leaf.c_str(),
+            (readWrite ? O_RDWR : O_WRONLY) | O_CREAT | O_TRUNC | O_CLOEXEC,
+            0666));
+#else
+    static_cast<void>(name);
+    static_cast<void>(readWrite);
+    return UniqueFd();
+#endif
+}
+
+auto OutputTree::openFile(path const& name) const -> UniqueFd {
+#ifdef XTRACTOBB_POSIX_IO
+    string    leaf;
+    int const dirfd = locate(name, leaf);
+    return UniqueFd(::openat(dirfd, leaf.c_str(), O_RDONLY | O_CLOEXEC));
+#else
+    static_cast<void>(name);
+    return UniqueFd();
+#endif
+}
+
+auto OutputTree::createStream(path const& name) const
+        -> unique_ptr<std::ostream> {
+#ifdef XTRACTOBB_POSIX_IO
+    namespace io = boost::iostreams;
+    UniqueFd file = createFile(name);
+    if (!file) {
+        return nullptr;
+    }
+    return std::make_unique<io::stream<io::file_descriptor_sink>>(
+            file.release(), io::close_handle);
+#else
+    auto fout = std::make_unique<boost::filesystem::ofstream>(
+            rootdir / name, std::ios::out | std::ios::binary);
+    if (!fout->good()) {
+        return nullptr;
+    }
+    return fout;
+#endif
+}
+
+auto OutputTree::createSymlink(path const& name, path const& target) const
+        -> bool {
+#ifdef XTRACTOBB_POSIX_IO
+    string       leaf;
+    int const    dirfd = locate(name, leaf);
+    string const dest  = target.string();
+    // One more byte than needed, to tell a longer target apart.
+    std::vector<char> current(dest.size() + 1);
+    ssize_t const     length
+            = ::readlinkat(dirfd, leaf.c_str(), current.data(), current.size());
+    if (length >= 0 && static_cast<size_t>(length) == dest.size()
+        && string_view(current.data(), dest.size()) == dest) {
+        return true;
+    }
+    ::unlinkat(dirfd, leaf.c_str(), 0);
+    return ::symlinkat(dest.c_str(), dirfd, leaf.c_str()) == 0;
+#else
+    boost::system::error_code errcode;
+    remove(rootdir / name, errcode);
+    create_symlink(target, rootdir / name, errcode);
+    return !errcode;
+#endif
+}
+
+auto OutputTree::cloneFile(path const& source, path const& name) const
+        -> bool {
+#ifdef XTRACTOBB_POSIX_IO
+    string    srcleaf;
+    string    leaf;
+    int const srcdirfd = locate(source, srcleaf);
+    int const dirfd    = locate(name, leaf);
+    ::unlinkat(dirfd, leaf.c_str(), 0);
+#    ifdef __linux__
+    if (tryReflinks) {
+        UniqueFd const src(
+                ::openat(srcdirfd, srcleaf.c_str(), O_RDONLY | O_CLOEXEC));
+        UniqueFd const dst(::openat(
+                dirfd, leaf.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                0666));
+        if (src && dst && ::ioctl(dst.get(), FICLONE, src.get()) == 0) {
+            return true;
+        }
+        if (src && dst
+            && (errno == EOPNOTSUPP || errno == EINVAL || errno == EXDEV
+                || errno == ENOTTY)) {
+            tryReflinks = false;
+        }
+        ::unlinkat(dirfd, leaf.c_str(), 0);
+    }
+#    endif
+    return ::linkat(srcdirfd, srcleaf.c_str(), dirfd, leaf.c_str(), 0) == 0;
+#else
+    boost::system::error_code errcode;
+    remove(rootdir / name, errcode);
+    create_hard_link(rootdir / source, rootdir / name, errcode);
+    return !errcode;
+#endif
+}
+
+void OutputTree::removeFile(path const& name) const noexcept {
+#ifdef XTRACTOBB_POSIX_IO
+    try {
+        string    leaf;
+        int const dirfd = locate(name, leaf);
+        ::unlinkat(dirfd, leaf.c_str(), 0);
+    } catch (...) {
+    }
+#else
+    boost::system::error_code errcode;
+    remove(rootdir / name, errcode);
+#endif
+}
+
+auto writeWholeFile(
+        OutputTree const& tree, path const& name, string_view data,
+        UniqueFd const& source, uint64_t srcOffset) -> bool {
+#ifdef XTRACTOBB_POSIX_IO
+    UniqueFd dst = tree.createFile(name);
+    if (!dst) {
+        return false;
+    }
+    size_t done = kernelCopy(source.get(), srcOffset, dst.get(), data.size());
+    while (done < data.size()) {
+        ssize_t written
+                = ::write(dst.get(), data.data() + done, data.size() - done);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(written);
+    }
+    // close can report delayed write errors on some filesystems.
+    return ::close(dst.release()) == 0;
+#else
+    static_cast<void>(source);
+    static_cast<void>(srcOffset);
+    boost::filesystem::ofstream fout(
+            tree.fullPath(name), std::ios::out | std::ios::binary);
+    fout.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return fout.good();
+#endif
+}
+
+OutputMapping::OutputMapping(
+        OutputTree const& _tree, path _name, size_t _length)
+        : tree(_tree), name(std::move(_name)), length(_length) {
+#ifdef XTRACTOBB_POSIX_IO
+    file = tree.createFile(name, true);
+    if (!file) {
+        return;
+    }
+    isValid = true;
+    if (length == 0) {
+        return;
+    }
+    auto const fileLength = static_cast<off_t>(length);
+#    if defined(__linux__)
+    // Filesystems without fallocate support still get the file extended.
+    // Any other error, such as a full disk, fails here: a sparse file would
+    // only fail once its pages are written, as a SIGBUS.
+    int const  error       = ::posix_fallocate(file.get(), 0, fileLength);
+    bool const unsupported = error == EOPNOTSUPP || error == EINVAL;
+    if ((error != 0 && !unsupported)
+        || (unsupported && ::ftruncate(file.get(), fileLength) != 0)) {
+        isValid = false;
+        return;
+    }
+#    else
+    if (::ftruncate(file.get(), fileLength) != 0) {
+        isValid = false;
+        return;
+    }
+#    endif
+    void* mapping = ::mmap(
+            nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, file.get(), 0);
+    if (mapping == MAP_FAILED) {
+        isValid = false;
+        return;
+    }
+    address = static_cast<char*>(mapping);
+#else
+    buffer.resize(length);
+    address = buffer.data();
+    isValid = true;
+#endif
+}
+
+auto OutputMapping::commit() noexcept -> bool {
+    if (!isValid) {
+        return false;
+    }
+    isValid = false;
+#ifdef XTRACTOBB_POSIX_IO
+    bool result = true;
+    if (address != nullptr) {
+        result  = ::munmap(address, length) == 0;
+        address = nullptr;
+    }
+    return ::close(file.release()) == 0 && result;
+#else
+    boost::filesystem::ofstream fout(
+            tree.fullPath(name), std::ios::out | std::ios::binary);
+    fout.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    return fout.good();
+#endif
+}
+
+OutputMapping::~OutputMapping() noexcept {
+#ifdef XTRACTOBB_POSIX_IO
+    if (address != nullptr) {
+        ::munmap(address, length);
+    }
+    if (file) {
+        file.reset();
+        tree.removeFile(name);
+    }
+#endif
+}
+
+InputMapping::InputMapping(OutputTree const& tree, path const& name) {
+#ifdef XTRACTOBB_POSIX_IO
+    UniqueFd const file = tree.openFile(name);
+    struct stat    info {};
+    if (!file || ::fstat(file.get(), &info) != 0) {
+        return;
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length != 0) {
+        void* mapping = ::mmap(
+                nullptr, length, PROT_READ, MAP_SHARED, file.get(), 0);
+        if (mapping == MAP_FAILED) {
+            return;
+        }
+        address = static_cast<char*>(mapping);
+    }
+    isValid = true;
+#else
+    boost::system::error_code errcode;
+    uintmax_t const size = file_size(tree.fullPath(name), errcode);
+    if (errcode) {
+        return;
+    }
+    boost::filesystem::ifstream fin(
+            tree.fullPath(name), std::ios::in | std::ios::binary);
+    buffer.resize(size);
+    fin.read(buffer.data(), static_cast<std::streamsize>(size));
+    if (!fin.good() && size != 0) {
+        return;
+    }
+    address = buffer.data();
+    length  = buffer.size();
+    isValid = true;
+#endif
+}
+
+InputMapping::~InputMapping() noexcept {
+#ifdef XTRACTOBB_POSIX_IO
+    if (address != nullptr) {
+        ::munmap(address, length);
+    }
+#endif
+}
@@ -0,0 +1,235 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    define XTRACTOBB_POSIX_IO 1
+#endif
+
+// Owning wrapper for a POSIX file descriptor. On platforms without POSIX I/O
+// it is always invalid, and the functions below fall back to iostreams.
+class UniqueFd {
+public:
+    UniqueFd() noexcept = default;
+    explicit UniqueFd(int _fd) noexcept : fd(_fd) {}
+    UniqueFd(UniqueFd const&) = delete;
+    UniqueFd(UniqueFd&& other) noexcept : fd(std::exchange(other.fd, -1)) {}
+    auto operator=(UniqueFd const&) -> UniqueFd& = delete;
+    auto operator=(UniqueFd&& other) noexcept -> UniqueFd& {
+        if (this != &other) {
+            reset(std::exchange(other.fd, -1));
+        }
+        return *this;
+    }
+    ~UniqueFd() noexcept {
+        reset();
+    }
+
+    [[nodiscard]] auto get() const noexcept -> int {
+        return fd;
+    }
+    [[nodiscard]] explicit operator bool() const noexcept {
+        return fd >= 0;
+    }
+    [[nodiscard]] auto release() noexcept -> int {
+        return std::exchange(fd, -1);
+    }
+    void reset(int _fd = -1) noexcept;
+
+private:
+    int fd = -1;
+};
+
+// Opens a file for reading; the result is invalid on failure.
+[[nodiscard]] auto openForReading(boost::filesystem::path const& fname)
+        -> UniqueFd;
+
+// The directory tree files are extracted to. Every directory is created once,
+// before extraction starts, and kept open, so files are created relative to
+// their directory with no further path lookups. Names are relative to the
+// root. Directories where this is not possible (including everywhere, on
+// platforms without POSIX I/O) fall back to full paths.
+//
+// After the directories have been added, any number of threads can create
+// files at the same time.
+class OutputTree {
+public:
+    // The root directory must already exist.
+    explicit OutputTree(boost::filesystem::path _root);
+    OutputTree(OutputTree const&) = delete;
+    OutputTree(OutputTree&&)      = delete;
+    auto operator=(OutputTree const&) -> OutputTree& = delete;
+    auto operator=(OutputTree&&) -> OutputTree& = delete;
+    // Gives the descriptors of its directories back to the budget.
+    ~OutputTree() noexcept;
+
+    [[nodiscard]] auto root() const noexcept
+            -> boost::filesystem::path const& {
+        return rootdir;
+    }
+    // Full path of a file in the tree, for messages.
+    [[nodiscard]] auto fullPath(boost::filesystem::path const& name) const
+            -> boost::filesystem::path {
+        return rootdir / name;
+    }
+    // Creates dir and any missing parents; returns false if it could not
+    // be created. Not thread-safe.
+    [[nodiscard]] auto addDirectory(boost::filesystem::path const& dir)
+            -> bool;
+    // True if dir was successfully added.
+    [[nodiscard]] auto hasDirectory(boost::filesystem::path const& dir) const
+            -> bool;
+    // Creates (or truncates) a file, open for writing, and also for reading
+    // if readWrite is set. The result is invalid on failure, and always
+    // without POSIX I/O.
+    [[nodiscard]] auto createFile(
+            boost::filesystem::path const& name, bool readWrite = false) const
+            -> UniqueFd;
+    // Opens a file for reading; the result is invalid on failure.
+    [[nodiscard]] auto openFile(boost::filesystem::path const& name) const
+            -> UniqueFd;
+    // Creates (or truncates) a file and returns a stream writing to it, or
+    // nothing if the file could not be created.
+    [[nodiscard]] auto createStream(boost::filesystem::path const& name) const
+            -> std::unique_ptr<std::ostream>;
+    // Makes name a symbolic link to target, replacing whatever file or link
+    // was there; a link that already points to target is left alone.
+    // Returns false if the link could not be created.
+    [[nodiscard]] auto createSymlink(
+            boost::filesystem::path const& name,
+            boost::filesystem::path const& target) const -> bool;
+    // Replaces name with a copy of source that shares its storage: a reflink
+    // where the filesystem supports them, or else a hard link. Returns false
+    // if neither could be made.
+    [[nodiscard]] auto cloneFile(
+            boost::filesystem::path const& source,
+            boost::filesystem::path const& name) const -> bool;
+    // Removes a file, ignoring errors.
+    void removeFile(boost::filesystem::path const& name) const noexcept;
+
+private:
+    // Descriptor of the directory holding name, or AT_FDCWD if it has to be
+    // reached by its full path. leaf is set to what to pass to the *at call.
+    [[nodiscard]] auto locate(
+            boost::filesystem::path const& name, std::string& leaf) const
+            -> int;
+
+    boost::filesystem::path rootdir;
+    // Keyed by generic path relative to the root; invalid descriptors mark
+    // directories that are only reachable by path.
+    std::unordered_map<std::string, UniqueFd> directories;
+    // How many directories are kept open. All trees share a budget of open
+    // directories; the rest of the descriptor limit is left for the files
+    // being written.
+    size_t heldFds = 0;
+    // Cleared the first time the filesystem turns out not to support
+    // reflinks, so that later clones go straight to hard links.
+    mutable std::atomic<bool> tryReflinks{true};
+};
+
+// Creates (or truncates) a file in the tree and writes data to it with as few
+// copies as possible. If source is valid and data is the same as its contents
+// starting at srcOffset, the kernel is asked to copy the bytes itself; this
+// falls back to writing straight from data where that is not supported.
+// Returns false if the file could not be created or written.
+[[nodiscard]] auto writeWholeFile(
+        OutputTree const& tree, boost::filesystem::path const& name,
+        std::string_view data, UniqueFd const& source, uint64_t srcOffset)
+        -> bool;
+
+// Replaces the contents of fname with data, unless it already has exactly
+// that contents, in which case the file (and its timestamp) is left alone.
+// The new contents are written to a temporary file first, so readers never see
+// a partially written file. Returns false if the file could not be written.
+[[nodiscard]] auto writeFileIfChanged(
+        boost::filesystem::path const& fname, std::string_view data) -> bool;
+
+// A new file of known size, mapped into memory for writing. Space for the
+// whole file is reserved upfront, so running out of disk shows up here and
+// not as a SIGBUS later. Without POSIX I/O, the contents are kept in memory
+// and written out on commit.
+class OutputMapping {
+public:
+    OutputMapping(
+            OutputTree const& _tree, boost::filesystem::path _name,
+            size_t _length);
+    OutputMapping(OutputMapping const&) = delete;
+    OutputMapping(OutputMapping&&)      = delete;
+    auto operator=(OutputMapping const&) -> OutputMapping& = delete;
+    auto operator=(OutputMapping&&) -> OutputMapping& = delete;
+    // Unmaps the file; if it was not committed, it also gets deleted.
+    ~OutputMapping() noexcept;
+
+    [[nodiscard]] auto valid() const noexcept -> bool {
+        return isValid;
+    }
+    [[nodiscard]] auto data() noexcept -> char* {
+        return address;
+    }
+    [[nodiscard]] auto size() const noexcept -> size_t {
+        return length;
+    }
+    // Unmaps and closes the file; returns false if any of that failed.
+    [[nodiscard]] auto commit() noexcept -> bool;
+
+private:
+    OutputTree const&       tree;
+    boost::filesystem::path name;
+    size_t                  length;
+    char*                   address = nullptr;
+    bool                    isValid = false;
+    UniqueFd                file;
+    std::vector<char>       buffer;
+};
+
+// An existing file in an output tree, mapped into memory for reading. Without
+// POSIX I/O, the contents are read into memory instead.
+class InputMapping {
+public:
+    InputMapping(OutputTree const& tree, boost::filesystem::path const& name);
+    InputMapping(InputMapping const&) = delete;
+    InputMapping(InputMapping&&)      = delete;
+    auto operator=(InputMapping const&) -> InputMapping& = delete;
+    auto operator=(InputMapping&&) -> InputMapping& = delete;
+    ~InputMapping() noexcept;
+
+    [[nodiscard]] auto valid() const noexcept -> bool {
+        return isValid;
+    }
+    [[nodiscard]] auto view() const noexcept -> std::string_view {
+        return {address, length};
+    }
+
+private:
+    char*             address = nullptr;
+    size_t            length  = 0;
+    bool              isValid = false;
+    std::vector<char> buffer;
+};
@@ -0,0 +1,106 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// XXH64 (https://github.com/Cyan4973/xxHash), used to tell whether two pieces
+// of data are the same without comparing them byte by byte. It runs at memory
+// speed, so hashing straight from the OBB mapping is cheap.
+namespace detail::xxh64 {
+    constexpr uint64_t const Prime1 = 11400714785074694791ULL;
+    constexpr uint64_t const Prime2 = 14029467366897019727ULL;
+    constexpr uint64_t const Prime3 = 1609587929392839161ULL;
+    constexpr uint64_t const Prime4 = 9650029242287828579ULL;
+    constexpr uint64_t const Prime5 = 2870177450012600261ULL;
+
+    constexpr auto rotl(uint64_t value, unsigned count) noexcept -> uint64_t {
+        return (value << count) | (value >> (64U - count));
+    }
+
+    template <typename T>
+    inline auto readLE(char const* ptr) noexcept -> T {
+        T value;
+        std::memcpy(&value, ptr, sizeof(T));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        if constexpr (sizeof(T) == 8) {
+            value = __builtin_bswap64(value);
+        } else {
+            value = __builtin_bswap32(value);
+        }
+#endif
+        return value;
+    }
+
+    constexpr auto round(uint64_t acc, uint64_t input) noexcept -> uint64_t {
+        return rotl(acc + input * Prime2, 31U) * Prime1;
+    }
+
+    constexpr auto merge(uint64_t acc, uint64_t value) noexcept -> uint64_t {
+        return (acc ^ round(0, value)) * Prime1 + Prime4;
+    }
+}    // namespace detail::xxh64
+
+[[nodiscard]] inline auto hashData(std::string_view data, uint64_t seed = 0)
+        -> uint64_t {
+    using namespace detail::xxh64;
+    char const*       ptr = data.data();
+    char const* const end = ptr + data.size();
+    uint64_t          hash;
+    if (data.size() >= 32) {
+        uint64_t v1 = seed + Prime1 + Prime2;
+        uint64_t v2 = seed + Prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - Prime1;
+        for (; end - ptr >= 32; ptr += 32) {
+            v1 = round(v1, readLE<uint64_t>(ptr));
+            v2 = round(v2, readLE<uint64_t>(ptr + 8));
+            v3 = round(v3, readLE<uint64_t>(ptr + 16));
+            v4 = round(v4, readLE<uint64_t>(ptr + 24));
+        }
+        hash = rotl(v1, 1U) + rotl(v2, 7U) + rotl(v3, 12U) + rotl(v4, 18U);
+        hash = merge(hash, v1);
+        hash = merge(hash, v2);
+        hash = merge(hash, v3);
+        hash = merge(hash, v4);
+    } else {
+        hash = seed + Prime5;
+    }
+    hash += data.size();
+    for (; end - ptr >= 8; ptr += 8) {
+        hash ^= round(0, readLE<uint64_t>(ptr));
+        hash = rotl(hash, 27U) * Prime1 + Prime4;
+    }
+    if (end - ptr >= 4) {
+        hash ^= readLE<uint32_t>(ptr) * Prime1;
+        hash = rotl(hash, 23U) * Prime2 + Prime3;
+        ptr += 4;
+    }
+    for (; ptr != end; ptr++) {
+        hash ^= static_cast<uint8_t>(*ptr) * Prime5;
+        hash = rotl(hash, 11U) * Prime1;
+    }
+    hash ^= hash >> 33U;
+    hash *= Prime2;
+    hash ^= hash >> 29U;
+    hash *= Prime3;
+    hash ^= hash >> 32U;
+    return hash;
+}
@@ -0,0 +1,166 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "inflateindex.hh"
+
+#include "endianio.hh"
+
+#include <algorithm>
+
+using std::optional;
+using std::runtime_error;
+using std::string;
+using std::string_view;
+using std::vector;
+
+using namespace std::literals::string_view_literals;
+
+namespace {
+    constexpr string_view const Signature  = "XOBBZIX\0"sv;
+    constexpr size_t const      WindowSize = InflateCheckpoint::WindowSize;
+
+    [[noreturn]] void corrupt() {
+        throw runtime_error("Inflate index is corrupt!");
+    }
+}    // namespace
+
+auto InflateIndex::isIndex(string_view data) noexcept -> bool {
+    return data.substr(0, Signature.size()) == Signature;
+}
+
+InflateIndex::InflateIndex(string_view data) {
+    if (data.size() < HeaderSize || !isIndex(data)) {
+        throw runtime_error("Inflate index is missing its signature!");
+    }
+    char const*    ptr     = data.data() + Signature.size();
+    uint32_t const version = Read4(ptr);
+    uint32_t const count   = Read4(ptr);
+    if (version != Version) {
+        throw runtime_error("Unsupported inflate index version!");
+    }
+    // Skips the span, which is only informative.
+    ptr = data.data() + HeaderSize;
+    char const* const end = data.data() + data.size();
+    for (uint32_t ii = 0; ii < count; ii++) {
+        if (static_cast<size_t>(end - ptr) < RecordSize) {
+            corrupt();
+        }
+        Record record;
+        record.offset             = Read4(ptr);
+        record.complength         = Read4(ptr);
+        record.fulllength         = Read4(ptr);
+        uint32_t const numPoints  = Read4(ptr);
+        uint32_t const nameLength = Read4(ptr);
+        size_t const   available  = static_cast<size_t>(end - ptr);
+        if (nameLength > available
+            || numPoints > (available - nameLength)
+                                   / (CheckpointSize + WindowSize)) {
+            corrupt();
+        }
+        string name(ptr, nameLength);
+        ptr += nameLength;
+        record.checkpoints.resize(numPoints);
+        uint32_t previous = 0;
+        for (auto& point : record.checkpoints) {
+            point.outOffset = Read4(ptr);
+            point.inOffset  = Read4(ptr);
+            point.bits      = static_cast<uint8_t>(*ptr);
+            ptr += CheckpointSize - 8;
+            point.window.assign(ptr, WindowSize);
+            ptr += WindowSize;
+            if (point.outOffset <= previous
+                || point.outOffset >= record.fulllength
+                || point.inOffset > record.complength || point.bits > 7) {
+                corrupt();
+            }
+            previous = point.outOffset;
+        }
+        records.insert_or_assign(std::move(name), std::move(record));
+    }
+}
+
+auto InflateIndex::find(ObbArchive const& archive, ObbEntry const& entry) const
+        -> vector<InflateCheckpoint> const* {
+    auto const found = records.find(entry.name);
+    if (found == records.cend()) {
+        return nullptr;
+    }
+    Record const& record = found->second;
+    if (record.offset != archive.offsetOf(entry)
+        || record.complength != entry.data.size()
+        || record.fulllength != entry.fulllength) {
+        return nullptr;
+    }
+    return &record.checkpoints;
+}
+
+void InflateIndex::retain(ObbArchive const& archive) {
+    for (auto iter = records.begin(); iter != records.end();) {
+        optional<ObbEntry> const entry = archive.find(iter->first);
+        if (entry && find(archive, *entry) != nullptr) {
+            ++iter;
+        } else {
+            iter = records.erase(iter);
+        }
+    }
+}
+
+void InflateIndex::add(
+        ObbArchive const& archive, ObbEntry const& entry,
+        vector<InflateCheckpoint> checkpoints) {
+    if (checkpoints.empty()) {
+        return;
+    }
+    Record record;
+    record.offset      = static_cast<uint32_t>(archive.offsetOf(entry));
+    record.complength  = static_cast<uint32_t>(entry.data.size());
+    record.fulllength  = entry.fulllength;
+    record.checkpoints = std::move(checkpoints);
+    records.insert_or_assign(string(entry.name), std::move(record));
+}
+
+auto InflateIndex::format() const -> string {
+    size_t length = HeaderSize;
+    for (auto const& [name, record] : records) {
+        length += RecordSize + name.size()
+                  + record.checkpoints.size() * (CheckpointSize + WindowSize);
+    }
+    string result(length, '\0');
+    char*  ptr = result.data();
+    std::copy(Signature.cbegin(), Signature.cend(), ptr);
+    ptr += Signature.size();
+    Write4(ptr, Version);
+    Write4(ptr, static_cast<uint32_t>(records.size()));
+    Write4(ptr, static_cast<uint32_t>(Span));
+    ptr = result.data() + HeaderSize;
+    for (auto const& [name, record] : records) {
+        Write4(ptr, record.offset);
+        Write4(ptr, record.complength);
+        Write4(ptr, record.fulllength);
+        Write4(ptr, static_cast<uint32_t>(record.checkpoints.size()));
+        Write4(ptr, static_cast<uint32_t>(name.size()));
+        ptr = std::copy(name.cbegin(), name.cend(), ptr);
+        for (auto const& point : record.checkpoints) {
+            Write4(ptr, point.outOffset);
+            Write4(ptr, point.inOffset);
+            *ptr = static_cast<char>(point.bits);
+            ptr += CheckpointSize - 8;
+            ptr = std::copy(point.window.cbegin(), point.window.cend(), ptr);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,103 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "codec.hh"
+#include "obbarchive.hh"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Sidecar file with inflate checkpoints for the large compressed entries of an
+// OBB, saved by xtractobb while it inflates them anyway. With it, reading from
+// the middle of such an entry only inflates from the checkpoint before it.
+//
+// All integers are little endian. The file starts with a 32-byte header:
+//
+//     Offset  Length  Content
+//     0       8       "XOBBZIX" followed by a NUL
+//     8       4       Format version (InflateIndex::Version)
+//     12      4       Number of records
+//     16      4       Output bytes between checkpoints (InflateIndex::Span)
+//     20      12      Reserved, zero
+//
+// It is followed by the records, back to back, in name order:
+//
+//     0       4       Offset of the data in the OBB
+//     4       4       Compressed size
+//     8       4       Uncompressed size
+//     12      4       Number of checkpoints
+//     16      4       Name length
+//     20      N       Name
+//
+// each followed by its checkpoints, in order of position:
+//
+//     0       4       Position in the inflated data
+//     4       4       Position in the compressed data
+//     8       1       Unused bits of the byte before it
+//     9       7       Reserved, zero
+//     16      32768   The inflated data before the checkpoint
+//
+// Records are matched to entries by name, position and sizes, so that an index
+// for a different version of the OBB is ignored rather than used.
+class InflateIndex {
+public:
+    static constexpr uint32_t const Version        = 1;
+    static constexpr size_t const   HeaderSize     = 32;
+    static constexpr size_t const   RecordSize     = 20;
+    static constexpr size_t const   CheckpointSize = 16;
+    static constexpr size_t const   Span           = size_t{1} << 20U;
+
+    // True if data starts with the signature of an index (of any version).
+    [[nodiscard]] __attribute__((pure)) static auto isIndex(
+            std::string_view data) noexcept -> bool;
+
+    InflateIndex() = default;
+    // Throws std::runtime_error if data is not a valid index.
+    explicit InflateIndex(std::string_view data);
+
+    [[nodiscard]] auto size() const noexcept -> size_t {
+        return records.size();
+    }
+    // Checkpoints of an entry of archive, or nullptr if there are none.
+    [[nodiscard]] __attribute__((pure)) auto find(
+            ObbArchive const& archive, ObbEntry const& entry) const
+            -> std::vector<InflateCheckpoint> const*;
+    // Drops the records which do not match an entry of archive.
+    void retain(ObbArchive const& archive);
+    // Entries without checkpoints are left out.
+    void add(
+            ObbArchive const& archive, ObbEntry const& entry,
+            std::vector<InflateCheckpoint> checkpoints);
+
+    [[nodiscard]] auto format() const -> std::string;
+
+private:
+    struct Record {
+        uint32_t                       offset     = 0U;
+        uint32_t                       complength = 0U;
+        uint32_t                       fulllength = 0U;
+        std::vector<InflateCheckpoint> checkpoints;
+    };
+
+    std::map<std::string, Record, std::less<>> records;
+};
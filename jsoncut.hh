@@ -0,0 +1,54 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+// Finds where a JSON document that arrives in pieces can be cut without
+// splitting a token, as jsont::Tokenizer::extend needs: right after a ',', '{'
+// or '[' outside of a string.
+class JsonCutFinder {
+public:
+    // Scans the next piece of the document, which starts at offset first;
+    // returns the last place to cut found so far.
+    auto scan(std::string_view piece, size_t first) noexcept -> size_t {
+        for (size_t ii = 0; ii < piece.size(); ii++) {
+            char const value = piece[ii];
+            if (inString) {
+                if (escaped) {
+                    escaped = false;
+                } else if (value == '\\') {
+                    escaped = true;
+                } else if (value == '"') {
+                    inString = false;
+                }
+            } else if (value == '"') {
+                inString = true;
+            } else if (value == ',' || value == '{' || value == '[') {
+                safeEnd = first + ii + 1;
+            }
+        }
+        return safeEnd;
+    }
+
+private:
+    size_t safeEnd  = 0;
+    bool   inString = false;
+    bool   escaped  = false;
+};
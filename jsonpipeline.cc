@@ -0,0 +1,297 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonpipeline.hh"
+
+#include "inflateindex.hh"
+#include "jsoncut.hh"
+#include "jsont.hh"
+#include "prettyJson.hh"
+#include "spscqueue.hh"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using std::lock_guard;
+using std::mutex;
+using std::string_view;
+using std::thread;
+using std::unique_lock;
+using std::vector;
+
+namespace {
+    constexpr size_t const InflateChunkSize = 256U * 1024U;
+    constexpr size_t const OutputChunkSize  = 64U * 1024U;
+    constexpr size_t const OutputQueueSize  = 8U;
+
+    using ChunkQueue = SpscQueue<vector<char>, OutputQueueSize>;
+
+    // The inflated document, filled in by the inflating thread and read by
+    // the formatting one. The buffer holds the whole document, as tokens
+    // point into it; ready only ever grows. The formatting thread sleeps until
+    // more is ready. Stored entries are read from the OBB as they are, and are
+    // ready from the start.
+    class InflatedInput {
+    public:
+        InflatedInput(
+                ObbEntry const& _entry, vector<InflateCheckpoint>* _checkpoints)
+                : entry(_entry), checkpoints(_checkpoints) {
+            if (entry.compressed()) {
+                buffer.resize(entry.fulllength);
+                document = buffer.data();
+            } else {
+                document = entry.data.data();
+                ready    = entry.data.size();
+                complete = true;
+            }
+        }
+
+        // Runs on the inflating thread.
+        void inflate() {
+            InflateStream stream(entry.data, buffer.size());
+            if (checkpoints != nullptr) {
+                stream.recordCheckpoints(InflateIndex::Span);
+            }
+            size_t total = 0;
+            while (total < buffer.size()) {
+                size_t const length
+                        = std::min(InflateChunkSize, buffer.size() - total);
+                size_t produced = 0;
+                status = stream.read(buffer.data() + total, length, produced);
+                if (status != InflateStatus::eOK || produced == 0) {
+                    if (status == InflateStatus::eOK) {
+                        status = InflateStatus::eDATA_ERROR;
+                    }
+                    finish(ready);
+                    return;
+                }
+                size_t const safeEnd = cuts.scan(
+                        string_view(buffer.data() + total, produced), total);
+                total += produced;
+                publish(safeEnd);
+            }
+            // Checks that the stream ends where the file table says.
+            while (status == InflateStatus::eOK && !stream.finished()) {
+                size_t produced = 0;
+                status          = stream.read(nullptr, 0, produced);
+            }
+            if (status == InflateStatus::eOK) {
+                if (checkpoints != nullptr) {
+                    *checkpoints = stream.takeCheckpoints();
+                }
+                finish(buffer.size());
+            } else {
+                finish(ready);
+            }
+        }
+        // Runs on the inflating thread if inflate() threw, so that the
+        // formatting thread stops waiting for more.
+        void abandon() {
+            lock_guard<mutex> lock(readyMutex);
+            complete = true;
+            readyChanged.notify_all();
+        }
+        // Waits until more than seen bytes are ready, or nothing more will
+        // be, and returns what is ready.
+        [[nodiscard]] auto waitForMore(size_t seen) const -> string_view {
+            unique_lock<mutex> lock(readyMutex);
+            readyChanged.wait(
+                    lock, [this, seen]() { return ready > seen || complete; });
+            return {document, ready};
+        }
+        [[nodiscard]] auto prefix(size_t length) const noexcept
+                -> string_view {
+            return {document, length};
+        }
+        [[nodiscard]] auto result() const noexcept -> InflateStatus {
+            return status;
+        }
+
+    private:
+        void publish(size_t length) {
+            {
+                lock_guard<mutex> lock(readyMutex);
+                ready = length;
+            }
+            readyChanged.notify_all();
+        }
+        void finish(size_t length) {
+            {
+                lock_guard<mutex> lock(readyMutex);
+                ready    = length;
+                complete = true;
+            }
+            readyChanged.notify_all();
+        }
+
+        ObbEntry const&            entry;
+        vector<InflateCheckpoint>* checkpoints;
+        vector<char>               buffer;
+        char const*                document = nullptr;
+        // Guards ready and complete.
+        mutable mutex                   readyMutex;
+        mutable std::condition_variable readyChanged;
+        size_t                          ready    = 0;
+        bool                            complete = false;
+        // Only written by the inflating thread before complete is set.
+        InflateStatus status = InflateStatus::eOK;
+        JsonCutFinder cuts;
+    };
+
+    // Tokenizes the document as it is being inflated.
+    class PipedReader {
+    public:
+        explicit PipedReader(InflatedInput const& _input)
+                : input(_input), available(input.waitForMore(0).size()),
+                  tokenizer(input.prefix(available)) {
+            if (tokenizer.current() == jsont::End) {
+                refill(jsont::End);
+            }
+        }
+
+        [[nodiscard]] auto current() const noexcept -> jsont::Token {
+            return tokenizer.current();
+        }
+        auto next() noexcept -> jsont::Token {
+            jsont::Token const previous = tokenizer.current();
+            if (tokenizer.next() == jsont::End) {
+                refill(previous);
+            }
+            return tokenizer.current();
+        }
+        [[nodiscard]] auto dataValue() const noexcept -> string_view {
+            return tokenizer.dataValue();
+        }
+        [[nodiscard]] auto errorMessage() const noexcept -> string_view {
+            return tokenizer.errorMessage();
+        }
+
+    private:
+        // Keeps going until there is a token, or the input really ended.
+        void refill(jsont::Token previous) noexcept {
+            while (tokenizer.current() == jsont::End) {
+                string_view const more = input.waitForMore(available);
+                if (more.size() == available) {
+                    return;
+                }
+                available = more.size();
+                tokenizer.extend(more, previous);
+                tokenizer.next();
+            }
+        }
+
+        InflatedInput const& input;
+        size_t               available;
+        jsont::Tokenizer     tokenizer;
+    };
+
+    // Collects formatted output into chunks for the writing thread.
+    class ChunkSink {
+    public:
+        explicit ChunkSink(ChunkQueue& _queue) : queue(_queue) {
+            chunk.reserve(OutputChunkSize);
+        }
+
+        auto operator<<(string_view const value) -> ChunkSink& {
+            chunk.insert(chunk.end(), value.cbegin(), value.cend());
+            if (chunk.size() >= OutputChunkSize) {
+                send();
+            }
+            return *this;
+        }
+        auto operator<<(char const value) -> ChunkSink& {
+            return *this << string_view(&value, 1);
+        }
+        // Sends what is left, and then an empty chunk to mark the end.
+        void finish() {
+            if (!chunk.empty()) {
+                send();
+            }
+            queue.push(vector<char>());
+        }
+
+    private:
+        void send() {
+            queue.push(std::move(chunk));
+            chunk = vector<char>();
+            chunk.reserve(OutputChunkSize);
+        }
+
+        ChunkQueue&  queue;
+        vector<char> chunk;
+    };
+}    // namespace
+
+auto pipeJson(
+        ObbEntry const& entry, std::ostream& out,
+        vector<InflateCheckpoint>* checkpoints) -> InflateStatus {
+    InflatedInput      input(entry, checkpoints);
+    ChunkQueue         queue;
+    thread             inflater;
+    std::exception_ptr inflateError;
+    if (entry.compressed()) {
+        inflater = thread([&input, &inflateError]() {
+            try {
+                input.inflate();
+            } catch (...) {
+                inflateError = std::current_exception();
+                input.abandon();
+            }
+        });
+    }
+    thread writer([&queue, &out]() {
+        while (true) {
+            vector<char> const chunk = queue.pop();
+            if (chunk.empty()) {
+                return;
+            }
+            // After an error, the rest is only drained.
+            if (out.good()) {
+                out.write(
+                        chunk.data(),
+                        static_cast<std::streamsize>(chunk.size()));
+            }
+        }
+    });
+
+    std::exception_ptr error;
+    ChunkSink          sink(queue);
+    try {
+        PipedReader reader(input);
+        printJSON(reader, sink, ePRETTY, 0U);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    sink.finish();
+    writer.join();
+    if (inflater.joinable()) {
+        inflater.join();
+    }
+    // Whatever went wrong while formatting most likely came from this.
+    if (inflateError) {
+        std::rethrow_exception(inflateError);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return input.result();
+}
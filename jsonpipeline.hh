@@ -0,0 +1,47 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "codec.hh"
+#include "obbarchive.hh"
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+// JSON entries at least this large are pretty-printed by pipeJson; for
+// smaller ones, starting its threads costs more than it saves.
+constexpr size_t const JsonPipelineMinSize = 1024U * 1024U;
+
+// Pretty-prints a JSON entry to out, as json_filter does, with inflating,
+// formatting and writing each running on its own thread, so that the entry
+// takes about as long as the slowest of them rather than their sum.
+//
+// Formatting starts as soon as some of the inflated data is ready: the
+// inflating thread publishes how much of its output can be tokenized without
+// splitting a token. Formatted output goes to the writing thread in chunks,
+// through a bounded queue; each side sleeps while it is full or empty.
+//
+// Returns the status of inflating the entry; unless it is eOK, the output is
+// incomplete. Write errors are left in the state of out. If checkpoints is not
+// null, it receives the checkpoints taken while inflating, for an
+// InflateIndex.
+[[nodiscard]] auto pipeJson(
+        ObbEntry const& entry, std::ostream& out,
+        std::vector<InflateCheckpoint>* checkpoints = nullptr)
+        -> InflateStatus;
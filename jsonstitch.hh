@@ -0,0 +1,147 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "jsont.hh"
+#include "prettyJson.hh"
+
+#include <boost/interprocess/streams/bufferstream.hpp>
+#include <boost/iostreams/filter/aggregate.hpp>
+#include <boost/iostreams/pipeline.hpp>
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <string_view>
+
+// Sorcery! JSON stitch filter for boost::filtering_ostream
+template <typename Ch, typename Alloc = std::allocator<Ch>>
+class basic_json_stitch_filter
+        : public boost::iostreams::aggregate_filter<Ch, Alloc> {
+private:
+    using base_type   = boost::iostreams::aggregate_filter<Ch, Alloc>;
+    using vector_type = typename base_type::vector_type;
+
+public:
+    using char_type = typename base_type::char_type;
+    using category  = typename base_type::category;
+
+    // TODO: Filter should receive output directory instead.
+    explicit basic_json_stitch_filter(std::string_view const _inkContent)
+            : inkContent(_inkContent) {}
+
+private:
+    auto printValueRaw(vectorstream& sint, jsont::Tokenizer& reader)
+            -> decltype(auto) {
+        return sint << reader.dataValue();
+    }
+
+    auto printValueObject(vectorstream& sint, jsont::Tokenizer& reader)
+            -> decltype(auto) {
+        return sint << reader.dataValue() << ':';
+    }
+
+    void handleObjectOrStitch(vectorstream& sint, jsont::Tokenizer& reader) {
+        using namespace std::literals::string_view_literals;
+        if (reader.dataValue() != R"("indexed-content")"sv) {
+            printValueObject(sint, reader);
+            return;
+        }
+        sint << R"("stitches":)"sv;
+        jsont::Token tok = reader.next();
+        assert(tok == jsont::ObjectStart);
+        printValueRaw(sint, reader);
+        tok = reader.next();
+        while (tok != jsont::ObjectEnd) {
+            assert(tok == jsont::FieldName);
+            if (reader.dataValue() == R"("filename")"sv) {
+                // TODO: instead of being discarded, this should be used with
+                // output directory to open stitch source file
+                tok = reader.next();    // Fetch filename...
+                assert(tok == jsont::String);
+                tok = reader.next();    // ... and discard it
+                assert(tok == jsont::Comma);
+                tok = reader.next();    // Discard comma after it as well
+            } else if (reader.dataValue() == R"("ranges")"sv) {
+                // The meat.
+                tok = reader.next();
+                assert(tok == jsont::ObjectStart);
+                tok = reader.next();
+                while (tok != jsont::ObjectEnd) {
+                    assert(tok == jsont::FieldName);
+                    printValueObject(sint, reader);
+                    tok = reader.next();
+                    assert(tok == jsont::String);
+                    std::string_view slice = reader.dataValue();
+                    // Remove starting double-quotes
+                    slice.remove_prefix(1);
+                    boost::interprocess::ibufferstream sptr(
+                            slice.data(), slice.length(),
+                            std::ios::in | std::ios::binary);
+                    unsigned offset = 0;
+                    unsigned length = 0;
+                    sptr >> offset >> length;
+                    std::string_view stitch(inkContent.substr(offset, length));
+
+                    if (stitch[0] == '[') {
+                        sint << R"({"content":)"sv << stitch << '}';
+                    } else {
+                        sint << stitch;
+                    }
+                    tok = reader.next();
+                    if (tok == jsont::Comma) {
+                        printValueRaw(sint, reader);
+                        tok = reader.next();
+                    }
+                }
+                assert(tok == jsont::ObjectEnd);
+                tok = reader.next();
+            }
+        }
+        assert(tok == jsont::ObjectEnd);
+        printValueRaw(sint, reader);
+    }
+
+    void do_filter(vector_type const& src, vector_type& dest) final {
+        vectorstream sint(std::ios::in | std::ios::out | std::ios::binary);
+        sint.reserve(src.size() * 3 / 2);
+        jsont::Tokenizer reader(src.data(), src.size());
+        jsont::Token     tok = reader.current();
+        while (true) {
+            if (tok == jsont::FieldName) {
+                handleObjectOrStitch(sint, reader);
+            } else if (tok == jsont::Error || tok == jsont::End) {
+                if (tok == jsont::Error) {
+                    std::cerr << reader.errorMessage() << std::endl;
+                }
+                sint.swap_vector(dest);
+                return;
+            } else {
+                printValueRaw(sint, reader);
+            }
+            tok = reader.next();
+        }
+        __builtin_unreachable();
+    }
+    std::string_view const inkContent;
+};
+// NOLINTNEXTLINE(modernize-use-trailing-return-type,readability-identifier-length)
+BOOST_IOSTREAMS_PIPABLE(basic_json_stitch_filter, 2)
+
+using json_stitch_filter  = basic_json_stitch_filter<char>;
+using wjson_stitch_filter = basic_json_stitch_filter<wchar_t>;
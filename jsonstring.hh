@@ -0,0 +1,40 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <iomanip>
+#include <ostream>
+#include <string_view>
+
+// Writes value as a JSON string literal, escaping quotes, backslashes and
+// control characters; other bytes are written as they are.
+inline void printJsonString(std::ostream& out, std::string_view const value) {
+    out << '"';
+    for (char const elem : value) {
+        auto const code = static_cast<unsigned char>(elem);
+        if (elem == '"' || elem == '\\') {
+            out << '\\' << elem;
+        } else if (code < 0x20U) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                << static_cast<unsigned>(code) << std::dec;
+        } else {
+            out << elem;
+        }
+    }
+    out << '"';
+}
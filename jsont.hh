@@ -50,6 +50,13 @@ namespace jsont {
         void reset(const char* bytes, size_t length) noexcept;
         void reset(std::string_view slice) noexcept;
 
+        // For input that arrives in pieces: after next() ran out of input and
+        // returned End, continues with slice, a longer view of the same
+        // input. previous is the token before End. Each piece must end right
+        // after a ',', '{' or '[' outside of a string, so that no token is
+        // split between pieces.
+        void extend(std::string_view slice, Token previous) noexcept;
+
         // True if the current token has a value
         auto hasValue() const noexcept -> bool;
 
@@ -154,6 +161,12 @@ namespace jsont {
         next();
     }
 
+    inline void Tokenizer::extend(
+            std::string_view slice, Token previous) noexcept {
+        _input = slice;
+        _token = previous;
+    }
+
     inline auto Tokenizer::hasValue() const noexcept -> bool {
         return _token >= Integer && _token <= FieldName;
     }
@@ -0,0 +1,150 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "listing.hh"
+
+#include "jsonstring.hh"
+
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using std::optional;
+using std::string;
+using std::string_view;
+using std::vector;
+
+using namespace std::literals::string_view_literals;
+
+namespace {
+    // Compressed size over uncompressed size; 1 for stored entries,
+    // including empty ones.
+    [[nodiscard]] auto ratioOf(EntryTable const& table, size_t index) noexcept
+            -> double {
+        if (table.fulllength(index) == 0U) {
+            return 1.0;
+        }
+        return static_cast<double>(table.complength(index))
+               / static_cast<double>(table.fulllength(index));
+    }
+
+    // Sorts entry indices by order's key, ascending or descending; the sort
+    // is stable, so ties stay in table order.
+    void sortIndices(
+            vector<uint32_t>& indices, EntryTable const& table,
+            ListOrder order, bool reverse) {
+        auto sortBy = [&](auto const& key) {
+            std::stable_sort(
+                    indices.begin(), indices.end(),
+                    [&](uint32_t lhs, uint32_t rhs) {
+                        return reverse ? key(rhs) < key(lhs)
+                                       : key(lhs) < key(rhs);
+                    });
+        };
+        switch (order) {
+        case ListOrder::eName:
+            // The file table is already sorted by name.
+            if (reverse) {
+                std::reverse(indices.begin(), indices.end());
+            }
+            break;
+        case ListOrder::eOffset:
+            sortBy([&table](uint32_t index) {
+                return table.offset(index);
+            });
+            break;
+        case ListOrder::eCompressed:
+            sortBy([&table](uint32_t index) {
+                return table.complength(index);
+            });
+            break;
+        case ListOrder::eSize:
+            sortBy([&table](uint32_t index) {
+                return table.fulllength(index);
+            });
+            break;
+        case ListOrder::eRatio:
+            sortBy([&table](uint32_t index) {
+                return ratioOf(table, index);
+            });
+            break;
+        }
+    }
+}    // namespace
+
+auto parseListOrder(string_view const key) -> optional<ListOrder> {
+    constexpr std::array<std::pair<string_view, ListOrder>, 5> const keys{{
+            {"name"sv, ListOrder::eName},
+            {"offset"sv, ListOrder::eOffset},
+            {"compressed"sv, ListOrder::eCompressed},
+            {"size"sv, ListOrder::eSize},
+            {"ratio"sv, ListOrder::eRatio},
+    }};
+    for (auto const& [name, order] : keys) {
+        if (name == key) {
+            return order;
+        }
+    }
+    return std::nullopt;
+}
+
+auto formatListing(
+        ObbArchive const& obb, NameFilter const& filter, ListOrder order,
+        bool reverse, ListFormat format) -> string {
+    EntryTable const table(obb);
+    vector<uint32_t> indices;
+    indices.reserve(table.size());
+    for (size_t ii = 0; ii < table.size(); ii++) {
+        if (filter.matches(table.name(ii))) {
+            indices.push_back(static_cast<uint32_t>(ii));
+        }
+    }
+    sortIndices(indices, table, order, reverse);
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(6);
+    if (format == ListFormat::eTSV) {
+        out << "name\toffset\tcompressed_bytes\tuncompressed_bytes\tratio\t"
+               "compressed\n"sv;
+        for (uint32_t const index : indices) {
+            out << table.name(index) << '\t' << table.offset(index) << '\t'
+                << table.complength(index) << '\t' << table.fulllength(index)
+                << '\t' << ratioOf(table, index) << '\t'
+                << (table.entry(index).compressed() ? "yes"sv : "no"sv)
+                << '\n';
+        }
+        return out.str();
+    }
+    out << '[';
+    char const* separator = "\n";
+    for (uint32_t const index : indices) {
+        out << separator << "    {\"name\": "sv;
+        printJsonString(out, table.name(index));
+        out << ", \"offset\": "sv << table.offset(index)
+            << ", \"compressed_bytes\": "sv << table.complength(index)
+            << ", \"uncompressed_bytes\": "sv << table.fulllength(index)
+            << ", \"ratio\": "sv << ratioOf(table, index)
+            << ", \"compressed\": "sv
+            << (table.entry(index).compressed() ? "true"sv : "false"sv) << '}';
+        separator = ",\n";
+    }
+    out << (indices.empty() ? "]\n"sv : "\n]\n"sv);
+    return out.str();
+}
@@ -0,0 +1,42 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "namefilter.hh"
+#include "obbarchive.hh"
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+// What --list sorts entries by. Ties keep the order of the file table, which
+// is by name.
+enum class ListOrder { eName, eOffset, eCompressed, eSize, eRatio };
+
+enum class ListFormat { eTSV, eJSON };
+
+// Parses a --sort key; returns nothing if there is no such key.
+[[nodiscard]] __attribute__((pure)) auto parseListOrder(
+        std::string_view key) -> std::optional<ListOrder>;
+
+// Lists the entries of the OBB selected by the filter, with their position,
+// sizes and compression ratio. Only the file table is read; nothing is
+// decompressed.
+[[nodiscard]] auto formatListing(
+        ObbArchive const& obb, NameFilter const& filter, ListOrder order,
+        bool reverse, ListFormat format) -> std::string;
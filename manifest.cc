@@ -0,0 +1,106 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "manifest.hh"
+
+#include "hash.hh"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <iomanip>
+#include <sstream>
+#include <string_view>
+
+using std::ios;
+using std::optional;
+using std::string;
+using std::string_view;
+
+using namespace std::literals::string_view_literals;
+
+using boost::filesystem::ifstream;
+using boost::filesystem::path;
+
+namespace {
+    // Bump whenever the format or the meaning of a field changes; manifests
+    // with other versions are ignored, so everything gets extracted again.
+    constexpr string_view const ManifestHeader = "xtractobb-manifest 1"sv;
+}    // namespace
+
+// Each line holds the fields of a record, tab-separated, with the name last;
+// hashes are in hexadecimal.
+auto loadManifest(path const& fname) -> Manifest {
+    Manifest manifest;
+    ifstream fin(fname, ios::in | ios::binary);
+    string   line;
+    if (!fin.good() || !std::getline(fin, line) || line != ManifestHeader) {
+        return manifest;
+    }
+    while (std::getline(fin, line)) {
+        std::istringstream sin(line);
+        ManifestRecord     record;
+        string             name;
+        sin >> record.offset >> record.complength >> record.fulllength
+            >> std::hex >> record.storedHash >> std::dec >> record.outputSize
+            >> std::hex >> record.outputHash;
+        if (!sin || sin.get() != '\t' || !std::getline(sin, name)
+            || name.empty()) {
+            // Corrupt manifest; extracting everything is always safe.
+            return Manifest{};
+        }
+        manifest.emplace(std::move(name), record);
+    }
+    return manifest;
+}
+
+auto formatManifest(Manifest const& manifest) -> string {
+    std::ostringstream sout(ios::out | ios::binary);
+    sout << ManifestHeader << '\n' << std::setfill('0');
+    for (auto const& [name, record] : manifest) {
+        sout << std::dec << record.offset << '\t' << record.complength << '\t'
+             << record.fulllength << '\t' << std::hex << std::setw(16)
+             << record.storedHash << '\t' << std::dec << record.outputSize
+             << '\t' << std::hex << std::setw(16) << record.outputHash << '\t'
+             << name << '\n';
+    }
+    return sout.str();
+}
+
+auto hashFile(OutputTree const& tree, path const& name) -> optional<FileHash> {
+    InputMapping const input(tree, name);
+    if (!input.valid()) {
+        return std::nullopt;
+    }
+    return FileHash{input.view().size(), hashData(input.view())};
+}
+
+auto findUpToDate(
+        Manifest const& previous, string_view name,
+        ManifestRecord const& source, OutputTree const& tree,
+        path const& outname) -> optional<ManifestRecord> {
+    auto const found = previous.find(name);
+    if (found == previous.cend() || !found->second.sameSource(source)) {
+        return std::nullopt;
+    }
+    auto const ondisk = hashFile(tree, outname);
+    if (!ondisk || ondisk->size != found->second.outputSize
+        || ondisk->hash != found->second.outputHash) {
+        return std::nullopt;
+    }
+    return found->second;
+}
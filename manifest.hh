@@ -0,0 +1,76 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "fileio.hh"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// What a previous run extracted for an entry: where the entry's data was in
+// the OBB, what it hashed to, and what the extracted file hashed to. If all of
+// these still match, the entry does not need to be extracted again.
+struct ManifestRecord {
+    uint64_t offset     = 0U;
+    uint32_t complength = 0U;
+    uint32_t fulllength = 0U;
+    uint64_t storedHash = 0U;
+    uint64_t outputSize = 0U;
+    uint64_t outputHash = 0U;
+
+    // True if both records describe the same stored data.
+    [[nodiscard]] auto sameSource(ManifestRecord const& other) const noexcept
+            -> bool {
+        return offset == other.offset && complength == other.complength
+               && fulllength == other.fulllength
+               && storedHash == other.storedHash;
+    }
+};
+
+// Records are keyed by entry name (or reference file name).
+using Manifest = std::map<std::string, ManifestRecord, std::less<>>;
+
+// Returns an empty manifest if the file is missing or not a valid manifest.
+[[nodiscard]] auto loadManifest(boost::filesystem::path const& fname)
+        -> Manifest;
+[[nodiscard]] auto formatManifest(Manifest const& manifest) -> std::string;
+
+struct FileHash {
+    uint64_t size = 0U;
+    uint64_t hash = 0U;
+};
+
+// Hashes the contents of a file in the output tree; empty if it could not be
+// read.
+[[nodiscard]] auto hashFile(
+        OutputTree const& tree, boost::filesystem::path const& name)
+        -> std::optional<FileHash>;
+
+// Returns the record of the previous run for the named file if it was made
+// from the same stored data and the file it wrote is still unchanged on disk.
+[[nodiscard]] auto findUpToDate(
+        Manifest const& previous, std::string_view name,
+        ManifestRecord const& source, OutputTree const& tree,
+        boost::filesystem::path const& outname)
+        -> std::optional<ManifestRecord>;
@@ -0,0 +1,49 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memorybudget.hh"
+
+using std::mutex;
+using std::unique_lock;
+
+void MemoryBudget::acquire(size_t cost) {
+    if (!enabled() || cost == 0U) {
+        return;
+    }
+    unique_lock<mutex> lock(budgetMutex);
+    if (cost > limit) {
+        oversized++;
+        released.wait(lock, [this] { return used == 0U; });
+        oversized--;
+    } else {
+        released.wait(lock, [this, cost] {
+            return oversized == 0U && used + cost <= limit;
+        });
+    }
+    used += cost;
+}
+
+void MemoryBudget::release(size_t cost) {
+    if (!enabled() || cost == 0U) {
+        return;
+    }
+    {
+        unique_lock<mutex> lock(budgetMutex);
+        used -= cost;
+    }
+    released.notify_all();
+}
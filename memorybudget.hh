@@ -0,0 +1,78 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// Limits how much memory the entries being extracted at the same time may
+// take, by their estimated peak footprint. Workers take a share of the
+// budget before starting an entry, and give it back once done; they wait
+// while it does not fit. An entry larger than the whole budget is only let
+// in when nothing else is running, and no other entry starts while it
+// waits, so that it is not starved by smaller ones. A limit of zero turns
+// it off.
+class MemoryBudget {
+public:
+    explicit MemoryBudget(size_t _limit) noexcept : limit(_limit) {}
+
+    [[nodiscard]] auto enabled() const noexcept -> bool {
+        return limit != 0U;
+    }
+    [[nodiscard]] auto capacity() const noexcept -> size_t {
+        return limit;
+    }
+    // Takes cost out of the budget for good, for memory that leases do not
+    // cover. It must be less than the capacity, and be set aside before
+    // anything is acquired.
+    void setAside(size_t cost) noexcept {
+        limit -= cost;
+    }
+    // Waits until cost fits, and takes it.
+    void acquire(size_t cost);
+    void release(size_t cost);
+
+    // Holds a share of the budget for as long as it lives.
+    class Lease {
+    public:
+        Lease(MemoryBudget& _budget, size_t _cost)
+                : budget(_budget), cost(_cost) {
+            budget.acquire(cost);
+        }
+        Lease(Lease const&) = delete;
+        Lease(Lease&&)      = delete;
+        auto operator=(Lease const&) -> Lease& = delete;
+        auto operator=(Lease&&) -> Lease& = delete;
+        ~Lease() noexcept {
+            budget.release(cost);
+        }
+
+    private:
+        MemoryBudget& budget;
+        size_t        cost;
+    };
+
+private:
+    size_t                  limit;
+    std::mutex              budgetMutex;
+    std::condition_variable released;
+    size_t                  used = 0U;
+    // Entries larger than the budget which are waiting to start.
+    size_t oversized = 0U;
+};
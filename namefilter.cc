@@ -0,0 +1,163 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "namefilter.hh"
+
+#include <algorithm>
+
+using std::istream;
+using std::regex;
+using std::regex_match;
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace {
+    // Matches a "[...]" set starting at pattern[0] against chr. Returns the
+    // length of the set in the pattern, or 0 if the set is not terminated
+    // (in which case '[' is matched literally).
+    auto matchSet(string_view pattern, char chr, bool& matched) -> size_t {
+        size_t pos    = 1;
+        bool   negate = false;
+        if (pos < pattern.size()
+            && (pattern[pos] == '!' || pattern[pos] == '^')) {
+            negate = true;
+            pos++;
+        }
+        bool found = false;
+        bool first = true;
+        while (pos < pattern.size() && (first || pattern[pos] != ']')) {
+            first           = false;
+            char const low  = pattern[pos];
+            char       high = low;
+            if (pos + 2 < pattern.size() && pattern[pos + 1] == '-'
+                && pattern[pos + 2] != ']') {
+                high = pattern[pos + 2];
+                pos += 2;
+            }
+            if (low <= chr && chr <= high) {
+                found = true;
+            }
+            pos++;
+        }
+        if (pos >= pattern.size()) {
+            return 0;
+        }
+        matched = found != negate;
+        return pos + 1;
+    }
+}    // namespace
+
+auto globMatch(string_view pattern, string_view fname) -> bool {
+    // Iterative matcher with single-star backtracking: on mismatch, retry by
+    // letting the last '*' seen consume one more character.
+    size_t pat     = 0;
+    size_t str     = 0;
+    size_t starPat = string_view::npos;
+    size_t starStr = 0;
+    while (str < fname.size()) {
+        if (pat < pattern.size()) {
+            char const chr = pattern[pat];
+            if (chr == '*') {
+                starPat = pat++;
+                starStr = str;
+                continue;
+            }
+            if (chr == '?') {
+                pat++;
+                str++;
+                continue;
+            }
+            if (chr == '[') {
+                bool         matched = false;
+                size_t const length
+                        = matchSet(pattern.substr(pat), fname[str], matched);
+                if (length != 0) {
+                    if (matched) {
+                        pat += length;
+                        str++;
+                        continue;
+                    }
+                } else if (fname[str] == '[') {
+                    pat++;
+                    str++;
+                    continue;
+                }
+            } else if (chr == fname[str]) {
+                pat++;
+                str++;
+                continue;
+            }
+        }
+        if (starPat == string_view::npos) {
+            return false;
+        }
+        pat = starPat + 1;
+        str = ++starStr;
+    }
+    while (pat < pattern.size() && pattern[pat] == '*') {
+        pat++;
+    }
+    return pat == pattern.size();
+}
+
+void NameFilter::include(string_view glob) {
+    includes.emplace_back(string(glob));
+}
+
+void NameFilter::includeRegex(string_view pattern) {
+    includes.emplace_back(regex(pattern.cbegin(), pattern.cend()));
+}
+
+void NameFilter::exclude(string_view glob) {
+    excludes.emplace_back(string(glob));
+}
+
+void NameFilter::excludeRegex(string_view pattern) {
+    excludes.emplace_back(regex(pattern.cbegin(), pattern.cend()));
+}
+
+void NameFilter::includeList(istream& list) {
+    string line;
+    while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            names.insert(line);
+        }
+    }
+}
+
+auto NameFilter::anyMatch(vector<Pattern> const& patterns, string_view fname)
+        -> bool {
+    return std::any_of(
+            patterns.cbegin(), patterns.cend(), [fname](auto const& pattern) {
+                if (auto const* glob = std::get_if<string>(&pattern)) {
+                    return globMatch(*glob, fname);
+                }
+                return regex_match(
+                        fname.cbegin(), fname.cend(), std::get<regex>(pattern));
+            });
+}
+
+auto NameFilter::matches(string_view fname) const -> bool {
+    bool const included = (includes.empty() && names.empty())
+                          || names.find(fname) != names.end()
+                          || anyMatch(includes, fname);
+    return included && !anyMatch(excludes, fname);
+}
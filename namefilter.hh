@@ -0,0 +1,61 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <functional>
+#include <istream>
+#include <regex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+// Matches a file name against a shell-style glob. '*' matches any sequence of
+// characters (including '/'), '?' matches any single character, and "[...]"
+// matches one character from a set, with ranges and '!' or '^' negation.
+[[nodiscard]] __attribute__((pure)) auto globMatch(
+        std::string_view pattern, std::string_view fname) -> bool;
+
+// Decides which OBB entries get extracted. A name is selected if it matches
+// any include pattern or is in the name list (or if there are neither), and
+// it matches no exclude pattern.
+class NameFilter {
+public:
+    void include(std::string_view glob);
+    void includeRegex(std::string_view pattern);
+    void exclude(std::string_view glob);
+    void excludeRegex(std::string_view pattern);
+    // Adds every non-empty line of the stream as an exact name to include.
+    void includeList(std::istream& list);
+
+    [[nodiscard]] auto selectsAll() const noexcept -> bool {
+        return includes.empty() && names.empty() && excludes.empty();
+    }
+    [[nodiscard]] auto matches(std::string_view fname) const -> bool;
+
+private:
+    using Pattern = std::variant<std::string, std::regex>;
+    [[nodiscard]] static auto anyMatch(
+            std::vector<Pattern> const& patterns, std::string_view fname)
+            -> bool;
+
+    std::vector<Pattern>               includes;
+    std::vector<Pattern>               excludes;
+    std::set<std::string, std::less<>> names;
+};
@@ -0,0 +1,135 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "obbarchive.hh"
+
+#include "endianio.hh"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <utility>
+
+using std::optional;
+using std::string_view;
+using std::vector;
+
+using namespace std::literals::string_view_literals;
+
+using boost::iostreams::mapped_file_source;
+
+ObbArchive::ObbArchive(mapped_file_source _source)
+        : source(std::move(_source)), obbview(source.data(), source.size()) {
+    if (obbview.size() < HeaderSize || obbview.substr(0, 8) != "AP_Pack!"sv) {
+        throw bad_obb(bad_obb::eSIGNATURE, "Input file missing signature!");
+    }
+    uint32_t const hlen = Read4(obbview.cbegin() + 8);
+    uint32_t const htbl = Read4(obbview.cbegin() + 12);
+    if (obbview.size() != hlen) {
+        throw bad_obb(bad_obb::eCORRUPT, "Incorrect length in header!");
+    }
+    if (htbl < HeaderSize || htbl > hlen || (hlen - htbl) % EntrySize != 0) {
+        throw bad_obb(bad_obb::eCORRUPT, "Invalid file table in header!");
+    }
+    tableOffset = htbl;
+    numEntries  = (hlen - htbl) / EntrySize;
+}
+
+auto ObbArchive::slice(uint32_t offset, uint32_t length) const -> string_view {
+    if (offset > obbview.size() || length > obbview.size() - offset) {
+        throw bad_obb(bad_obb::eCORRUPT, "File table entry out of bounds!");
+    }
+    return obbview.substr(offset, length);
+}
+
+auto ObbArchive::entry(size_t index) const -> ObbEntry {
+    char const*    ptr        = record(index);
+    uint32_t const nameOffset = Read4(ptr);
+    uint32_t const nameLength = Read4(ptr);
+    uint32_t const dataOffset = Read4(ptr);
+    uint32_t const complength = Read4(ptr);
+    uint32_t const fulllength = Read4(ptr);
+    return {slice(nameOffset, nameLength), slice(dataOffset, complength),
+            fulllength};
+}
+
+auto ObbArchive::find(string_view fname) const -> optional<ObbEntry> {
+    size_t first = 0;
+    size_t count = numEntries;
+    while (count > 0) {
+        size_t const      step       = count / 2;
+        char const*       ptr        = record(first + step);
+        uint32_t const    nameOffset = Read4(ptr);
+        uint32_t const    nameLength = Read4(ptr);
+        string_view const name       = slice(nameOffset, nameLength);
+        if (name < fname) {
+            first += step + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+    if (first == numEntries) {
+        return std::nullopt;
+    }
+    ObbEntry found = entry(first);
+    if (found.name != fname) {
+        return std::nullopt;
+    }
+    return found;
+}
+
+EntryTable::EntryTable(ObbArchive const& archive)
+        : obbview(archive.contents()), nameOffsets(archive.size()),
+          nameLengths(archive.size()), dataOffsets(archive.size()),
+          complengths(archive.size()), fulllengths(archive.size()) {
+    char const*    ptr   = archive.record(0);
+    uint64_t const limit = obbview.size();
+    // Bounds are checked for all entries at once, so the loop has no
+    // branches.
+    bool outOfBounds = false;
+    for (size_t ii = 0; ii < size(); ii++) {
+        nameOffsets[ii] = Read4(ptr);
+        nameLengths[ii] = Read4(ptr);
+        dataOffsets[ii] = Read4(ptr);
+        complengths[ii] = Read4(ptr);
+        fulllengths[ii] = Read4(ptr);
+        outOfBounds |= uint64_t{nameOffsets[ii]} + nameLengths[ii] > limit;
+        outOfBounds |= uint64_t{dataOffsets[ii]} + complengths[ii] > limit;
+    }
+    if (outOfBounds) {
+        for (size_t ii = 0; ii < size(); ii++) {
+            try {
+                static_cast<void>(archive.entry(ii));
+            } catch (bad_obb const& except) {
+                throw bad_obb(
+                        bad_obb::eCORRUPT,
+                        "Entry " + std::to_string(ii) + ": " + except.what());
+            }
+        }
+    }
+}
+
+auto EntryTable::byPosition() const -> vector<uint32_t> {
+    vector<uint32_t> order(size());
+    std::iota(order.begin(), order.end(), 0U);
+    std::sort(order.begin(), order.end(), [this](uint32_t lhs, uint32_t rhs) {
+        return dataOffsets[lhs] < dataOffsets[rhs]
+               || (dataOffsets[lhs] == dataOffsets[rhs] && lhs < rhs);
+    });
+    return order;
+}
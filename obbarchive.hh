@@ -0,0 +1,186 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A file stored in an OBB. Both views point into the mapping owned by the
+// ObbArchive the entry came from, and are valid for as long as it lives.
+struct ObbEntry {
+    std::string_view name;
+    std::string_view data;
+    uint32_t         fulllength = 0U;
+
+    [[nodiscard]] auto compressed() const noexcept -> bool {
+        return data.size() != fulllength;
+    }
+};
+
+class bad_obb final : public std::runtime_error {
+public:
+    enum Reason { eSIGNATURE, eCORRUPT };
+
+    bad_obb(Reason _reason, char const* message)
+            : std::runtime_error(message), reason_(_reason) {}
+    bad_obb(Reason _reason, std::string const& message)
+            : std::runtime_error(message), reason_(_reason) {}
+
+    [[nodiscard]] auto reason() const noexcept -> Reason {
+        return reason_;
+    }
+
+private:
+    Reason reason_;
+};
+
+// Read-only view of a memory-mapped OBB. The header and the bounds of the file
+// table are validated once on construction; entries are decoded from the
+// table on demand, and never copied.
+class ObbArchive {
+public:
+    static constexpr size_t const HeaderSize = 16;
+    static constexpr size_t const EntrySize  = 20;
+
+    // Walks the file table in order, decoding each entry as it is reached.
+    class const_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = ObbEntry;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = ObbEntry;
+
+        const_iterator(ObbArchive const& _archive, size_t _index) noexcept
+                : archive(&_archive), index(_index) {}
+
+        [[nodiscard]] auto operator*() const -> ObbEntry {
+            return archive->entry(index);
+        }
+        auto operator++() noexcept -> const_iterator& {
+            index++;
+            return *this;
+        }
+        auto operator++(int) noexcept -> const_iterator {
+            const_iterator const copy(*this);
+            index++;
+            return copy;
+        }
+        [[nodiscard]] auto operator==(
+                const_iterator const& other) const noexcept -> bool {
+            return index == other.index;
+        }
+        [[nodiscard]] auto operator!=(
+                const_iterator const& other) const noexcept -> bool {
+            return index != other.index;
+        }
+
+    private:
+        ObbArchive const* archive;
+        size_t            index;
+    };
+
+    // Throws bad_obb if the header or the file table bounds are invalid.
+    explicit ObbArchive(boost::iostreams::mapped_file_source source);
+
+    [[nodiscard]] auto contents() const noexcept -> std::string_view {
+        return obbview;
+    }
+    [[nodiscard]] auto size() const noexcept -> size_t {
+        return numEntries;
+    }
+    // Position of the entry's data in the OBB file.
+    [[nodiscard]] auto offsetOf(ObbEntry const& entry) const noexcept
+            -> uint64_t {
+        return static_cast<uint64_t>(entry.data.data() - obbview.data());
+    }
+    // Throws bad_obb if the entry points outside of the OBB.
+    [[nodiscard]] auto entry(size_t index) const -> ObbEntry;
+    [[nodiscard]] auto begin() const noexcept -> const_iterator {
+        return {*this, 0};
+    }
+    [[nodiscard]] auto end() const noexcept -> const_iterator {
+        return {*this, numEntries};
+    }
+    // The file table is sorted by name (repackobb writes it that way too),
+    // so this is a binary search.
+    [[nodiscard]] auto find(std::string_view fname) const
+            -> std::optional<ObbEntry>;
+
+private:
+    friend class EntryTable;
+
+    [[nodiscard]] auto record(size_t index) const noexcept -> char const* {
+        return obbview.data() + tableOffset + index * EntrySize;
+    }
+    [[nodiscard]] auto slice(uint32_t offset, uint32_t length) const
+            -> std::string_view;
+
+    boost::iostreams::mapped_file_source source;
+    std::string_view                     obbview;
+    size_t                               tableOffset = 0;
+    size_t                               numEntries  = 0;
+};
+
+// The whole file table of an ObbArchive, decoded in a single pass into one
+// array per field. Entries keep their index in the file table; names and data
+// are only turned into views into the mapping when asked for. Suited to code
+// that goes over every entry, such as ordering them by position.
+class EntryTable {
+public:
+    // Throws bad_obb if any entry points outside of the OBB.
+    explicit EntryTable(ObbArchive const& archive);
+
+    [[nodiscard]] auto size() const noexcept -> size_t {
+        return dataOffsets.size();
+    }
+    [[nodiscard]] auto name(size_t index) const noexcept -> std::string_view {
+        return obbview.substr(nameOffsets[index], nameLengths[index]);
+    }
+    [[nodiscard]] auto offset(size_t index) const noexcept -> uint32_t {
+        return dataOffsets[index];
+    }
+    [[nodiscard]] auto complength(size_t index) const noexcept -> uint32_t {
+        return complengths[index];
+    }
+    [[nodiscard]] auto fulllength(size_t index) const noexcept -> uint32_t {
+        return fulllengths[index];
+    }
+    [[nodiscard]] auto entry(size_t index) const noexcept -> ObbEntry {
+        return {name(index),
+                obbview.substr(dataOffsets[index], complengths[index]),
+                fulllengths[index]};
+    }
+    // Indices of all entries, in the order of their data in the OBB.
+    [[nodiscard]] auto byPosition() const -> std::vector<uint32_t>;
+
+private:
+    std::string_view      obbview;
+    std::vector<uint32_t> nameOffsets;
+    std::vector<uint32_t> nameLengths;
+    std::vector<uint32_t> dataOffsets;
+    std::vector<uint32_t> complengths;
+    std::vector<uint32_t> fulllengths;
+};
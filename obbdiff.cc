@@ -0,0 +1,210 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "obbdiff.hh"
+
+#include "codec.hh"
+#include "jsonstring.hh"
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <sstream>
+#include <string_view>
+
+using std::ostream;
+using std::string;
+using std::string_view;
+
+using namespace std::literals::string_view_literals;
+
+namespace {
+    // Produces the contents of an entry a piece at a time, inflating it if
+    // it is compressed.
+    class ContentReader {
+    public:
+        explicit ContentReader(ObbEntry const& entry) : stored(entry.data) {
+            if (entry.compressed()) {
+                inflater.emplace(entry.data, entry.fulllength);
+            }
+        }
+
+        // Reads the next length bytes of the contents; returns false if the
+        // data is invalid.
+        [[nodiscard]] auto fill(char* output, size_t length) -> bool {
+            if (!inflater) {
+                stored.copy(output, length);
+                stored.remove_prefix(length);
+                return true;
+            }
+            while (length > 0) {
+                size_t produced = 0;
+                if (inflater->read(output, length, produced)
+                            != InflateStatus::eOK
+                    || produced == 0) {
+                    return false;
+                }
+                output += produced;
+                length -= produced;
+            }
+            return true;
+        }
+        // Checks that compressed data ends after the last byte was read.
+        [[nodiscard]] auto finish() -> bool {
+            while (inflater && !inflater->finished()) {
+                size_t produced = 0;
+                if (inflater->read(nullptr, 0, produced)
+                    != InflateStatus::eOK) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        string_view                  stored;
+        std::optional<InflateStream> inflater;
+    };
+
+    void printSizes(ostream& out, ObbEntry const& entry) {
+        out << "{\"compressed_bytes\": "sv << entry.data.size()
+            << ", \"uncompressed_bytes\": "sv << entry.fulllength << '}';
+    }
+
+    void printEntries(
+            ostream& out, string_view const key,
+            std::vector<ObbEntry> const& entries) {
+        out << "    \""sv << key << "\": ["sv;
+        char const* separator = "\n";
+        for (ObbEntry const& entry : entries) {
+            out << separator << "        {\"name\": "sv;
+            printJsonString(out, entry.name);
+            out << ", \"compressed_bytes\": "sv << entry.data.size()
+                << ", \"uncompressed_bytes\": "sv << entry.fulllength << '}';
+            separator = ",\n";
+        }
+        out << (entries.empty() ? "],\n"sv : "\n    ],\n"sv);
+    }
+}    // namespace
+
+auto compareTables(
+        ObbArchive const& older, ObbArchive const& newer,
+        NameFilter const& filter) -> ObbDiff {
+    // Both file tables are sorted by name, so they can be merged.
+    EntryTable const oldTable(older);
+    EntryTable const newTable(newer);
+    ObbDiff          diff;
+    size_t           oldIndex = 0;
+    size_t           newIndex = 0;
+    while (oldIndex < oldTable.size() || newIndex < newTable.size()) {
+        bool const hasOld = oldIndex < oldTable.size();
+        bool const hasNew = newIndex < newTable.size();
+        if (hasOld
+            && (!hasNew || oldTable.name(oldIndex) < newTable.name(newIndex))) {
+            ObbEntry const entry = oldTable.entry(oldIndex++);
+            if (filter.matches(entry.name)) {
+                diff.removed.push_back(entry);
+            }
+            continue;
+        }
+        if (!hasOld || newTable.name(newIndex) < oldTable.name(oldIndex)) {
+            ObbEntry const entry = newTable.entry(newIndex++);
+            if (filter.matches(entry.name)) {
+                diff.added.push_back(entry);
+            }
+            continue;
+        }
+        EntryPair const pair{
+                oldTable.entry(oldIndex++), newTable.entry(newIndex++)};
+        if (!filter.matches(pair.older.name)) {
+            continue;
+        }
+        if (pair.older.fulllength != pair.newer.fulllength) {
+            diff.modified.push_back(pair);
+        } else if (pair.older.data == pair.newer.data) {
+            diff.unchanged++;
+        } else if (pair.older.compressed() || pair.newer.compressed()) {
+            diff.ambiguous.push_back(pair);
+        } else {
+            diff.modified.push_back(pair);
+        }
+    }
+    return diff;
+}
+
+auto sameContents(EntryPair const& pair) -> bool {
+    constexpr size_t const      ChunkSize = 64U * 1024U;
+    std::array<char, ChunkSize> lhsBuffer;
+    std::array<char, ChunkSize> rhsBuffer;
+    ContentReader               lhs(pair.older);
+    ContentReader               rhs(pair.newer);
+    // Both have the same size.
+    size_t remaining = pair.older.fulllength;
+    while (remaining > 0) {
+        size_t const length = std::min(remaining, ChunkSize);
+        if (!lhs.fill(lhsBuffer.data(), length)
+            || !rhs.fill(rhsBuffer.data(), length)
+            || string_view(lhsBuffer.data(), length)
+                       != string_view(rhsBuffer.data(), length)) {
+            return false;
+        }
+        remaining -= length;
+    }
+    return lhs.finish() && rhs.finish();
+}
+
+auto formatDiff(ObbDiff const& diff, ListFormat format) -> string {
+    std::ostringstream out;
+    if (format == ListFormat::eTSV) {
+        out << "status\tname\told_compressed_bytes\told_uncompressed_bytes\t"
+               "new_compressed_bytes\tnew_uncompressed_bytes\n"sv;
+        // Sizes of the side an entry is missing from are left empty.
+        for (ObbEntry const& entry : diff.added) {
+            out << "added\t"sv << entry.name << "\t\t\t"sv << entry.data.size()
+                << '\t' << entry.fulllength << '\n';
+        }
+        for (ObbEntry const& entry : diff.removed) {
+            out << "removed\t"sv << entry.name << '\t' << entry.data.size()
+                << '\t' << entry.fulllength << "\t\t\n"sv;
+        }
+        for (EntryPair const& pair : diff.modified) {
+            out << "modified\t"sv << pair.older.name << '\t'
+                << pair.older.data.size() << '\t' << pair.older.fulllength
+                << '\t' << pair.newer.data.size() << '\t'
+                << pair.newer.fulllength << '\n';
+        }
+        return out.str();
+    }
+    out << "{\n"sv;
+    printEntries(out, "added"sv, diff.added);
+    printEntries(out, "removed"sv, diff.removed);
+    out << "    \"modified\": ["sv;
+    char const* separator = "\n";
+    for (EntryPair const& pair : diff.modified) {
+        out << separator << "        {\"name\": "sv;
+        printJsonString(out, pair.older.name);
+        out << ", \"old\": "sv;
+        printSizes(out, pair.older);
+        out << ", \"new\": "sv;
+        printSizes(out, pair.newer);
+        out << '}';
+        separator = ",\n";
+    }
+    out << (diff.modified.empty() ? "],\n"sv : "\n    ],\n"sv);
+    out << "    \"unchanged\": "sv << diff.unchanged << "\n}\n"sv;
+    return out.str();
+}
@@ -0,0 +1,60 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "listing.hh"
+#include "namefilter.hh"
+#include "obbarchive.hh"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// An entry that is in both OBBs.
+struct EntryPair {
+    ObbEntry older;
+    ObbEntry newer;
+};
+
+// How two OBBs differ. All lists are sorted by name.
+struct ObbDiff {
+    std::vector<ObbEntry>  added;
+    std::vector<ObbEntry>  removed;
+    std::vector<EntryPair> modified;
+    // Entries with the same uncompressed size whose stored bytes differ, at
+    // least one of them compressed. They may still inflate to the same file,
+    // which only decompressing them can tell.
+    std::vector<EntryPair> ambiguous;
+    size_t                 unchanged = 0U;
+};
+
+// Compares the file tables of two OBBs by name, then by sizes, then by the
+// stored bytes of the entries, for the names selected by the filter. Nothing
+// is decompressed; entries that would need it are left in ambiguous.
+[[nodiscard]] auto compareTables(
+        ObbArchive const& older, ObbArchive const& newer,
+        NameFilter const& filter) -> ObbDiff;
+
+// Inflates both entries a piece at a time, stopping at the first difference.
+// Entries with invalid compressed data are different.
+[[nodiscard]] auto sameContents(EntryPair const& pair) -> bool;
+
+// Lists the added, removed and modified entries, with their sizes. JSON
+// output also counts the unchanged entries.
+[[nodiscard]] auto formatDiff(ObbDiff const& diff, ListFormat format)
+        -> std::string;
@@ -15,6 +15,8 @@
  *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#pragma once
+
 enum PrettyJSON { eNO_WHITESPACE = -1, ePRETTY = 0, eCOMPACT = 1 };
 
 #include "jsont.hh"
@@ -30,9 +32,11 @@ using vectorstream = boost::interprocess::basic_vectorstream<std::vector<char>>;
 #    define INDENT_CHAR '\t'
 #endif
 
-template <typename Dst>
+// Reader is a jsont::Tokenizer, or anything with the same current(), next(),
+// dataValue() and errorMessage().
+template <typename Reader, typename Dst>
 void printJSON(
-        jsont::Tokenizer& reader, Dst& sint, PrettyJSON const pretty,
+        Reader& reader, Dst& sint, PrettyJSON const pretty,
         size_t newlineForceIndent) {
     size_t       indent    = 0;
     bool         needValue = false;
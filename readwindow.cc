@@ -0,0 +1,146 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "readwindow.hh"
+
+#include "fileio.hh"
+
+#include <algorithm>
+
+#ifdef XTRACTOBB_POSIX_IO
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+using std::lock_guard;
+using std::mutex;
+using std::string_view;
+using std::vector;
+
+namespace {
+    [[nodiscard]] auto pageSize() noexcept -> size_t {
+#ifdef XTRACTOBB_POSIX_IO
+        static size_t const value = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return value;
+#else
+        return 4096U;
+#endif
+    }
+
+    [[nodiscard]] auto pageDown(size_t offset) noexcept -> size_t {
+        return offset - offset % pageSize();
+    }
+
+    [[nodiscard]] auto pageUp(size_t offset) noexcept -> size_t {
+        return pageDown(offset + pageSize() - 1);
+    }
+}    // namespace
+
+ReadWindow::ReadWindow(
+        string_view mapping, int _fd, size_t _size,
+        vector<string_view> const& items)
+        : base(mapping.data()), length(mapping.size()), fd(_fd), size(_size),
+          done(items.size(), false) {
+    starts.reserve(items.size());
+    ends.reserve(items.size());
+    for (string_view const data : items) {
+        auto const start = static_cast<size_t>(data.data() - base);
+        starts.push_back(start);
+        ends.push_back(start + data.size());
+        end = std::max(end, ends.back());
+    }
+    floors.resize(starts.size());
+    size_t lowest = end;
+    for (size_t ii = starts.size(); ii-- > 0;) {
+        lowest     = std::min(lowest, starts[ii]);
+        floors[ii] = lowest;
+    }
+}
+
+void ReadWindow::drop(size_t from, size_t to) const noexcept {
+#ifdef XTRACTOBB_POSIX_IO
+    ::madvise(const_cast<char*>(base + from), to - from, MADV_DONTNEED);
+#    ifdef POSIX_FADV_DONTNEED
+    if (fd >= 0) {
+        ::posix_fadvise(
+                fd, static_cast<off_t>(from), static_cast<off_t>(to - from),
+                POSIX_FADV_DONTNEED);
+    }
+#    endif
+#else
+    static_cast<void>(from);
+    static_cast<void>(to);
+#endif
+}
+
+void ReadWindow::claim(size_t index) {
+    if (!enabled()) {
+        return;
+    }
+    lock_guard<mutex> lock(windowMutex);
+    size_t const start = starts[index];
+    // An entry outside of the window starts a new one. Otherwise, the window
+    // is topped up once half of it has been used, rather than for every
+    // entry.
+    bool const inWindow = start >= windowStart && start <= prefetched;
+    if (inWindow && prefetched >= std::min(start + size / 2, end)) {
+        return;
+    }
+    size_t const first = inWindow ? prefetched : start;
+    size_t const last  = std::min(start + size, end);
+#ifdef XTRACTOBB_POSIX_IO
+    size_t const from = pageDown(first);
+    size_t const to   = std::min(pageUp(last), length);
+    ::madvise(const_cast<char*>(base + from), to - from, MADV_WILLNEED);
+#endif
+    if (!inWindow) {
+        windowStart = start;
+    }
+    prefetched = last;
+}
+
+void ReadWindow::finish(size_t index) {
+    if (!enabled()) {
+        return;
+    }
+    lock_guard<mutex> lock(windowMutex);
+    done[index] = true;
+    while (firstPending < done.size() && done[firstPending]) {
+        firstPending++;
+    }
+    // An entry read before others that come earlier in the OBB is dropped
+    // right away, except for the pages it may share with its neighbours.
+    if (floors[index] < starts[index]) {
+        size_t const from = pageUp(starts[index]);
+        size_t const to   = pageDown(ends[index]);
+        if (from < to) {
+            drop(from, to);
+        }
+    }
+    // The page holding the start of the first entry still to be read is
+    // kept.
+    size_t const limit = pageDown(
+            firstPending < floors.size() ? floors[firstPending] : end);
+    // Likewise, pages are dropped in batches of a quarter of the window.
+    if (limit <= released
+        || (limit - released < size / 4 && firstPending < done.size())) {
+        return;
+    }
+    drop(released, limit);
+    released = limit;
+}
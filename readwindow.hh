@@ -0,0 +1,79 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Bounds how much of a memory-mapped OBB stays resident while its entries
+// are read in position order by several workers. Ahead of the entries being
+// read, a window of the given size is prefetched; behind the first entry not
+// yet finished, the pages are dropped from the mapping and from the page
+// cache. A size of zero turns it off. Pages that are dropped and touched
+// again are simply read back, so this never affects correctness.
+//
+// Entries may also be read out of order, such as large ones being taken
+// first: the window then restarts at such an entry, only pages behind every
+// entry still to be read are dropped, and the pages of an entry read ahead
+// of others are dropped as soon as it is finished.
+class ReadWindow {
+public:
+    ReadWindow() noexcept = default;
+    // items are the data of the entries, in the order they will be claimed,
+    // which should mostly be by position; all of them must point into
+    // mapping. fd is the mapped file, and may be invalid.
+    ReadWindow(
+            std::string_view mapping, int fd, size_t size,
+            std::vector<std::string_view> const& items);
+
+    // Called before the entry at index is read.
+    void claim(size_t index);
+    // Called once the entry at index will not be read again.
+    void finish(size_t index);
+
+private:
+    [[nodiscard]] auto enabled() const noexcept -> bool {
+        return size != 0U;
+    }
+    // Drops the pages in [from, to) from the mapping and the page cache.
+    void drop(size_t from, size_t to) const noexcept;
+
+    char const* base   = nullptr;
+    size_t      length = 0U;
+    int         fd     = -1;
+    size_t      size   = 0U;
+    // Where the data of each entry starts and ends, relative to base, and
+    // where the data of the last one ends.
+    std::vector<size_t> starts;
+    std::vector<size_t> ends;
+    size_t              end = 0U;
+    // The lowest start of each entry and of all entries claimed after it.
+    std::vector<size_t> floors;
+
+    std::mutex        windowMutex;
+    std::vector<bool> done;
+    // First entry that is not finished yet.
+    size_t firstPending = 0U;
+    // Everything before released has been dropped; everything from
+    // windowStart to prefetched has been prefetched.
+    size_t released    = 0U;
+    size_t windowStart = 0U;
+    size_t prefetched  = 0U;
+};
@@ -15,14 +15,19 @@
  *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "console.hh"
+#include "codec.hh"
 #include "fileentry.hh"
+#include "fileindex.hh"
 #include "jsont.hh"
 #include "prettyJson.hh"
+#include "stats.hh"
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 #include <boost/interprocess/streams/bufferstream.hpp>
 #include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/device/file.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
@@ -40,6 +45,7 @@
 #include <iostream>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <regex>
 #include <sstream>
 #include <string>
@@ -53,10 +59,10 @@ using std::cerr;
 using std::cout;
 using std::endl;
 using std::exception;
-using std::flush;
 using std::ios;
 using std::istream;
 using std::numeric_limits;
+using std::optional;
 using std::ostream;
 using std::regex;
 using std::regex_match;
@@ -77,7 +83,7 @@ using boost::filesystem::ofstream;
 using boost::filesystem::path;
 using boost::iostreams::aggregate_filter;
 using boost::iostreams::filtering_ostream;
-using boost::iostreams::zlib_compressor;
+using boost::iostreams::mapped_file_source;
 namespace zlib = boost::iostreams::zlib;
 
 using ibufferstream = boost::interprocess::basic_ibufferstream<char>;
@@ -206,7 +212,8 @@ enum ErrorCodes {
     eINPUT_NO_ACCESS,
     eINPUT_NO_FILE_TABLE,
     eINPUT_FILES_MISSING,
-    eINPUT_FILES_NOT_VALID
+    eINPUT_FILES_NOT_VALID,
+    eINVALID_ARGS
 };
 
 [[nodiscard]] auto openObbFile(path const& obbfile) {
@@ -270,14 +277,38 @@ void checkFile(path const& fpath) {
         cerr << "Path "sv << indir << " must be a directory!"sv << endl << endl;
         throw ErrorCodes{eINPUT_NOT_DIR};
     }
-    // Read file list.
-    path const filetable(indir / "FileTable.ser");
-    checkFile(filetable);
+    // Read file list. Older versions of xtractobb saved it as a text archive
+    // instead of an index, so both are accepted.
+    path const          fileindex(indir / "FileTable.idx");
+    path const          filetable(indir / "FileTable.ser");
     vector<RFile_entry> entries;
-    {
-        ifstream      file_table(indir / "FileTable.ser");
+    if (exists(fileindex)) {
+        checkFile(fileindex);
+        try {
+            mapped_file_source const mapping(fileindex);
+            FileIndex const index(string_view(mapping.data(), mapping.size()));
+            entries.reserve(index.size());
+            for (size_t ii = 0; ii < index.size(); ii++) {
+                FileIndex::Record const record = index[ii];
+                entries.emplace_back(
+                        record.name, File_data{}, record.compressed);
+            }
+        } catch (exception const& except) {
+            cerr << "Invalid file table "sv << fileindex << ": "sv
+                 << except.what() << endl
+                 << endl;
+            throw ErrorCodes{eINPUT_FILES_NOT_VALID};
+        }
+    } else if (exists(filetable)) {
+        checkFile(filetable);
+        ifstream      file_table(filetable);
         text_iarchive archive(file_table);
         archive >> entries;
+    } else {
+        cerr << "Input path "sv << indir
+             << " has no file table! Please re-dump the OBB."sv << endl
+             << endl;
+        throw ErrorCodes{eINPUT_NO_FILE_TABLE};
     }
 
     // TODO: Main json file should be found from Info.plist file:
@@ -311,8 +342,9 @@ inline auto roundUp(uint32_t numToRound, uint32_t multiple) -> uint32_t {
     return ((numToRound + multiple - 1) / multiple) * multiple;
 }
 
-auto encodeFile(ofstream& obbContents, path const& infile, bool compressed)
-        -> tuple<uint32_t, uint32_t, uint32_t> {
+auto encodeFile(
+        ofstream& obbContents, path const& infile, bool compressed,
+        CodecBackend backend) -> tuple<uint32_t, uint32_t, uint32_t> {
     path const parentdir(infile.parent_path());
     // Sanity check; if someone else is modifying the input directory as we
     // process the files, we should stop.
@@ -330,18 +362,26 @@ auto encodeFile(ofstream& obbContents, path const& infile, bool compressed)
         // process the files, we should stop.
         assert(fin.good());
 
+        // Files to compress are deflated in one go by the codec backend,
+        // so they are gathered in memory first.
+        string plain;
         {
             filtering_ostream fsout;
             if (isJson) {
                 fsout.push(json_filter(eNO_WHITESPACE, &fulllength));
             }
             if (compressed) {
-                fsout.push(zlib_compressor(
-                        zlib::best_compression, 1ULL * 1024ULL * 1024ULL));
+                fsout.push(boost::iostreams::back_inserter(plain));
+            } else {
+                fsout.push(sint);
             }
-            fsout.push(sint);
             fsout << fin.rdbuf();
         }
+        if (compressed) {
+            string const packed
+                    = deflateInto(plain, zlib::best_compression, backend);
+            sint.write(packed.data(), static_cast<streamsize>(packed.size()));
+        }
     }
 
     sint.seekg(0);
@@ -374,11 +414,11 @@ auto writeJSON(
 }
 
 void unpackReferenceFile(
-        path const& indir, string const& referenceFile,
+        Console& console, path const& indir, string const& referenceFile,
         string const& mainJsonFile, string const& inkcontentFile) {
-    cout << "\33[2K\rRe-generating "sv << inkcontentFile << " and "sv
-         << mainJsonFile << " from reference file "sv << referenceFile
-         << "... "sv << flush;
+    console.progress(
+            "Re-generating "sv, inkcontentFile, " and "sv, mainJsonFile,
+            " from reference file "sv, referenceFile, "... "sv);
     ofstream          inkfile;
     filtering_ostream fsinkfile;
     writeJSON(indir / inkcontentFile, inkfile, fsinkfile, nullptr);
@@ -391,24 +431,74 @@ void unpackReferenceFile(
     ifstream reffile(indir / referenceFile, ios::in | ios::binary);
 
     fsmainfile << reffile.rdbuf();
-    cout << "done."sv << flush;
+    console.append("done."sv);
 }
 
 extern "C" auto main(int argc, char* argv[]) -> int;
 
 auto main(int argc, char* argv[]) -> int {
     try {
-        if (argc != 3) {
-            cerr << "Usage: "sv << argv[0] << " inputdir outputfile"sv << endl
+        // Accepts "--stats FILE", "--stats=FILE", "--codec NAME" and
+        // "--codec=NAME" anywhere.
+        string              statsfile;
+        string              codec;
+        vector<char const*> positional;
+        for (int ii = 1; ii < argc; ii++) {
+            string_view const arg(argv[ii]);
+            if (arg == "--stats"sv && ii + 1 < argc) {
+                statsfile = argv[++ii];
+            } else if (arg.substr(0, "--stats="sv.size()) == "--stats="sv) {
+                statsfile = arg.substr("--stats="sv.size());
+            } else if (arg == "--codec"sv && ii + 1 < argc) {
+                codec = argv[++ii];
+            } else if (arg.substr(0, "--codec="sv.size()) == "--codec="sv) {
+                codec = arg.substr("--codec="sv.size());
+            } else {
+                positional.push_back(argv[ii]);
+            }
+        }
+        if (positional.size() != 2) {
+            cerr << "Usage: "sv << argv[0]
+                 << " [--stats FILE] [--codec NAME] inputdir outputfile"sv
+                 << endl
+                 << "Codecs in this build: "sv << codecBackendNames()
+                 << "; the default is zlib."sv << endl
                  << endl;
             return eWRONG_ARGC;
         }
+        // Other backends compress to different bytes, so they are only used
+        // when asked for.
+        CodecBackend deflateBackend = CodecBackend::eZlib;
+        if (!codec.empty()) {
+            optional<CodecBackend> const backend = findCodecBackend(codec);
+            if (!backend) {
+                cerr << "Codec '"sv << codec
+                     << "' is not available; this build has "sv
+                     << codecBackendNames() << "."sv << endl
+                     << endl;
+                return eINVALID_ARGS;
+            }
+            deflateBackend = *backend;
+        }
+        optional<StatsReport> stats;
+        if (!statsfile.empty()) {
+            stats.emplace("repackobb"s);
+        }
+        Stopwatch  phase;
+        auto const endPhase = [&](string_view const name) {
+            double const seconds = phase.lap();
+            if (stats) {
+                stats->addPhase(name, seconds);
+            }
+        };
+        Console console(cout);
 
-        path const indir(argv[1]);
+        path const indir(positional[0]);
         auto [entries, referenceFile, mainJsonFile, inkcontentFile]
                 = readInputDir(indir);
+        endPhase("table_parse"sv);
 
-        path const obbfile(argv[2]);
+        path const obbfile(positional[1]);
         auto       obbptr      = openObbFile(obbfile);
         auto&      obbcontents = *obbptr;
 
@@ -418,19 +508,30 @@ auto main(int argc, char* argv[]) -> int {
         Write4(obbcontents, 0U);    // Placeholder for file table position
         curr_offset += 8;
 
-        unpackReferenceFile(indir, referenceFile, mainJsonFile, inkcontentFile);
+        unpackReferenceFile(
+                console, indir, referenceFile, mainJsonFile, inkcontentFile);
+        endPhase("reference_unstitching"sv);
 
         for (auto& elem : entries) {
-            cout << "\33[2K\rPacking file "sv << elem.name() << flush;
+            Stopwatch const timer;
+            console.progress("Packing file "sv, elem.name());
             path infile(indir / elem.name());
             auto [file_fulllength, file_complength, file_padding]
-                    = encodeFile(obbcontents, infile, elem.compressed);
+                    = encodeFile(
+                            obbcontents, infile, elem.compressed,
+                            deflateBackend);
             elem.fdata = {curr_offset, file_fulllength, file_complength};
             curr_offset += file_complength + file_padding;
+            if (stats) {
+                stats->addEntry(EntryStats{
+                        elem.name(), file_complength, file_fulllength,
+                        timer.elapsed()});
+            }
         }
+        endPhase("packing"sv);
 
-        cout << endl;
-        cout << "\33[2K\rCreating name table... "sv << flush;
+        console.append('\n');
+        console.progress("Creating name table... "sv);
         unordered_map<string, uint32_t> nameOffsets;
         for (auto& elem : entries) {
             string const& fname = elem.fname;
@@ -439,7 +540,7 @@ auto main(int argc, char* argv[]) -> int {
             obbcontents.write(
                     fname.data(), static_cast<uint32_t>(fname.size()));
         }
-        cout << "done."sv << endl;
+        console.append("done.\n"sv);
 
         uint32_t const padding = roundUp(curr_offset, 16U) - curr_offset;
         constexpr static const array<char, 16U> nullPadding{};
@@ -451,7 +552,7 @@ auto main(int argc, char* argv[]) -> int {
             return lhs.name() < rhs.name();
         });
 
-        cout << "\33[2K\rCreating file table... "sv << flush;
+        console.progress("Creating file table... "sv);
         uint32_t file_table_pos = curr_offset;
         for (auto& elem : entries) {
             string const& fname = elem.fname;
@@ -468,7 +569,16 @@ auto main(int argc, char* argv[]) -> int {
         obbcontents.seekp(curr_pos);
         Write4(obbcontents, curr_offset);
         Write4(obbcontents, file_table_pos);
-        cout << "done."sv << endl;
+        console.append("done.\n"sv);
+        endPhase("tables"sv);
+
+        if (stats) {
+            ofstream fout(path(statsfile), ios::out | ios::binary);
+            fout << stats->format();
+            if (!fout.good()) {
+                cerr << "Could not write file "sv << statsfile << "!"sv << endl;
+            }
+        }
     } catch (exception const& except) {
         cerr << except.what() << endl;
     } catch (ErrorCodes err) {
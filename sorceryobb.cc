@@ -0,0 +1,351 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sorceryobb.hh"
+
+#include "jsoncut.hh"
+#include "jsonstitch.hh"
+#include "jsont.hh"
+#include "prettyJson.hh"
+
+#include <boost/interprocess/streams/bufferstream.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+using std::optional;
+using std::string;
+using std::string_view;
+using std::vector;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+using boost::filesystem::path;
+using boost::iostreams::filtering_ostream;
+using boost::iostreams::mapped_file_source;
+
+namespace {
+    [[noreturn]] void throwInflateError(InflateStatus status) {
+        throw bad_obb(
+                bad_obb::eCORRUPT,
+                status == InflateStatus::eSIZE_MISMATCH
+                        ? "Decompressed size does not match file table!"
+                        : "Invalid compressed data!");
+    }
+
+    // Tokenizes a JSON entry, only reading as much of it as the tokens asked
+    // for so far need.
+    class LazyJsonReader {
+    public:
+        static constexpr size_t const ChunkSize = 64U * 1024U;
+
+        explicit LazyJsonReader(ObbEntry const& entry)
+                : reader(entry), buffer(entry.fulllength, '\0'),
+                  tokenizer(string_view()) {
+            refill(jsont::End);
+        }
+
+        [[nodiscard]] auto current() const noexcept -> jsont::Token {
+            return tokenizer.current();
+        }
+        auto next() -> jsont::Token {
+            jsont::Token const previous = tokenizer.current();
+            if (tokenizer.next() == jsont::End) {
+                refill(previous);
+            }
+            return tokenizer.current();
+        }
+        [[nodiscard]] auto dataValue() const noexcept -> string_view {
+            return tokenizer.dataValue();
+        }
+
+    private:
+        // Keeps going until there is a token, or the input really ended.
+        void refill(jsont::Token previous) {
+            while (tokenizer.current() == jsont::End && read < buffer.size()) {
+                size_t const produced = reader.read(
+                        buffer.data() + read,
+                        std::min(ChunkSize, buffer.size() - read));
+                if (produced == 0) {
+                    throwInflateError(InflateStatus::eSIZE_MISMATCH);
+                }
+                size_t const safeEnd = cuts.scan(
+                        string_view(buffer.data() + read, produced), read);
+                read += produced;
+                size_t const end = read == buffer.size() ? read : safeEnd;
+                if (end == available) {
+                    continue;
+                }
+                available = end;
+                tokenizer.extend(
+                        string_view(buffer.data(), available), previous);
+                tokenizer.next();
+            }
+        }
+
+        EntryReader      reader;
+        string           buffer;
+        size_t           read      = 0;
+        size_t           available = 0;
+        JsonCutFinder    cuts;
+        jsont::Tokenizer tokenizer;
+    };
+
+    struct StitchRange {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    // Finds where a stitch is in the inkcontent, from the
+    // indexed-content/ranges object of the main json, reading no further.
+    [[nodiscard]] auto findStitch(ObbEntry const& mainJson, string_view name)
+            -> optional<StitchRange> {
+        using jsont::Token;
+        LazyJsonReader reader(mainJson);
+        string const   key = '"' + string(name) + '"';
+        // How many objects and arrays the current token is in, and how far
+        // down indexed-content/ranges it is.
+        size_t depth = 0;
+        size_t level = 0;
+        for (Token tok = reader.current(); tok != jsont::End;
+             tok       = reader.next()) {
+            switch (tok) {
+            case jsont::Error:
+                throw bad_obb(bad_obb::eCORRUPT, "Invalid main json!");
+            case jsont::ObjectStart:
+            case jsont::ArrayStart:
+                depth++;
+                break;
+            case jsont::ObjectEnd:
+            case jsont::ArrayEnd:
+                depth--;
+                // Left the ranges, or indexed-content without them.
+                if (level != 0 && depth <= level) {
+                    return std::nullopt;
+                }
+                break;
+            case jsont::FieldName: {
+                if (depth != level + 1) {
+                    break;
+                }
+                string_view const field = reader.dataValue();
+                if ((level == 0 && field == R"("indexed-content")"sv)
+                    || (level == 1 && field == R"("ranges")"sv)) {
+                    if (reader.next() != jsont::ObjectStart) {
+                        return std::nullopt;
+                    }
+                    depth++;
+                    level++;
+                } else if (level == 2 && field == key) {
+                    if (reader.next() != jsont::String) {
+                        return std::nullopt;
+                    }
+                    string_view slice = reader.dataValue();
+                    // Remove starting double-quotes
+                    slice.remove_prefix(1);
+                    boost::interprocess::ibufferstream sptr(
+                            slice.data(), slice.length(),
+                            std::ios::in | std::ios::binary);
+                    StitchRange range{0, 0};
+                    sptr >> range.offset >> range.length;
+                    return range;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+        }
+        return std::nullopt;
+    }
+}    // namespace
+
+auto openArchive(path const& obbfile) -> ObbArchive {
+    return ObbArchive(mapped_file_source(obbfile));
+}
+
+auto StoryFiles::hasReference() const noexcept -> bool {
+    return mainJson && inkContent && !mainJson->data.empty()
+           && !inkContent->data.empty();
+}
+
+auto StoryFiles::referenceName() const -> string {
+    if (!mainJson) {
+        return {};
+    }
+    return string(mainJson->name.substr(0, "SorceryN"sv.size()))
+           + "-Reference.json"s;
+}
+
+// TODO: Main json file should be found from Info.plist file:
+//  main json filename = dict["StoryFilename"sv] + ".json"
+// TODO: inkcontent filename should be found from main json:
+// inkcontent filename = indexed-content/filename
+auto findStoryFiles(ObbArchive const& archive) -> StoryFiles {
+    StoryFiles story;
+    for (char digit = '0'; digit <= '9'; digit++) {
+        string const base = "Sorcery"s + digit;
+        if (!story.mainJson) {
+            story.mainJson = archive.find(base + ".json"s);
+        }
+        if (!story.mainJson) {
+            story.mainJson = archive.find(base + ".minjson"s);
+        }
+        if (!story.inkContent) {
+            story.inkContent = archive.find(base + ".inkcontent"s);
+        }
+    }
+    return story;
+}
+
+auto entryView(ObbEntry const& entry) noexcept -> optional<string_view> {
+    if (entry.compressed()) {
+        return std::nullopt;
+    }
+    return entry.data;
+}
+
+auto readEntry(ObbEntry const& entry) -> string {
+    if (!entry.compressed()) {
+        return string(entry.data);
+    }
+    string              result(entry.fulllength, '\0');
+    InflateStatus const status
+            = inflateInto(entry.data, result.data(), result.size());
+    if (status != InflateStatus::eOK) {
+        throwInflateError(status);
+    }
+    return result;
+}
+
+auto readEntryRange(
+        ObbEntry const& entry, size_t offset, size_t length,
+        vector<InflateCheckpoint> const* checkpoints) -> string {
+    if (offset > entry.fulllength || length > entry.fulllength - offset) {
+        throw bad_obb(bad_obb::eCORRUPT, "Range is outside of the entry!");
+    }
+    if (!entry.compressed()) {
+        return string(entry.data.substr(offset, length));
+    }
+    vector<InflateCheckpoint> const none;
+    string                          result(length, '\0');
+    InflateStatus const             status = inflateRange(
+            entry.data, entry.fulllength,
+            checkpoints != nullptr ? *checkpoints : none, offset,
+            result.data(), result.size());
+    if (status != InflateStatus::eOK) {
+        throwInflateError(status);
+    }
+    return result;
+}
+
+auto formatJson(string_view json) -> string {
+    string result;
+    {
+        filtering_ostream fsout;
+        fsout.push(json_filter(ePRETTY));
+        fsout.push(boost::iostreams::back_inserter(result));
+        fsout.write(json.data(), static_cast<std::streamsize>(json.size()));
+    }
+    return result;
+}
+
+auto readReference(StoryFiles const& story) -> string {
+    if (!story.hasReference()) {
+        throw bad_obb(bad_obb::eCORRUPT, "Story files are missing!");
+    }
+    // The stitch filter needs the inkcontent in memory; it is normally stored
+    // uncompressed, in which case it is used from the mapping.
+    string      inkStorage;
+    string_view inkData = story.inkContent->data;
+    if (story.inkContent->compressed()) {
+        inkStorage = readEntry(*story.inkContent);
+        inkData    = inkStorage;
+    }
+    string const mainJson = readEntry(*story.mainJson);
+    string       result;
+    {
+        filtering_ostream fsout;
+        fsout.push(json_stitch_filter(inkData));
+        fsout.push(json_filter(ePRETTY));
+        fsout.push(boost::iostreams::back_inserter(result));
+        fsout.write(
+                mainJson.data(), static_cast<std::streamsize>(mainJson.size()));
+    }
+    return result;
+}
+
+auto readStitch(
+        StoryFiles const& story, string_view name,
+        vector<InflateCheckpoint> const* inkCheckpoints) -> optional<string> {
+    if (!story.hasReference()) {
+        throw bad_obb(bad_obb::eCORRUPT, "Story files are missing!");
+    }
+    optional<StitchRange> const range = findStitch(*story.mainJson, name);
+    if (!range) {
+        return std::nullopt;
+    }
+    ObbEntry const& ink = *story.inkContent;
+    size_t const    end = size_t{range->offset} + range->length;
+    if (end > ink.fulllength) {
+        throw bad_obb(bad_obb::eCORRUPT, "Stitch is outside of inkcontent!");
+    }
+    string stitch
+            = readEntryRange(ink, range->offset, range->length, inkCheckpoints);
+    // The same as the stitch filter does for the reference file.
+    if (!stitch.empty() && stitch[0] == '[') {
+        stitch = R"({"content":)"s + stitch + '}';
+    }
+    return formatJson(stitch);
+}
+
+EntryReader::EntryReader(ObbEntry const& _entry) : entry(_entry) {
+    if (entry.compressed()) {
+        inflater.emplace(entry.data, entry.fulllength);
+    }
+}
+
+auto EntryReader::read(char* output, size_t length) -> size_t {
+    if (length == 0) {
+        return 0;
+    }
+    if (!inflater) {
+        length = std::min(length, entry.data.size() - offset);
+        std::memcpy(output, entry.data.data() + offset, length);
+        offset += length;
+        return length;
+    }
+    // A single inflate call can produce nothing, such as when it only reads
+    // the zlib header, so keep going until there is output or the end.
+    while (!inflater->finished()) {
+        size_t              produced = 0;
+        InflateStatus const status   = inflater->read(output, length, produced);
+        if (status != InflateStatus::eOK) {
+            throwInflateError(status);
+        }
+        offset += produced;
+        if (produced != 0) {
+            return produced;
+        }
+    }
+    return 0;
+}
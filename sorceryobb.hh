@@ -0,0 +1,104 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// Public API of libsorceryobb, for reading OBB contents in memory instead of
+// extracting them to disk. All views and streams refer to the mapping owned
+// by the ObbArchive they came from, and must not outlive it.
+
+#include "codec.hh"
+#include "obbarchive.hh"
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Maps and validates an OBB file. Throws bad_obb if it is not a valid OBB, and
+// std::ios_base::failure if it cannot be mapped.
+[[nodiscard]] auto openArchive(boost::filesystem::path const& obbfile)
+        -> ObbArchive;
+
+// The files which are combined into the reference file.
+struct StoryFiles {
+    std::optional<ObbEntry> mainJson;
+    std::optional<ObbEntry> inkContent;
+
+    // True if there is enough to build the reference file.
+    [[nodiscard]] __attribute__((pure)) auto hasReference() const noexcept
+            -> bool;
+    // "SorceryN-Reference.json", or empty if there is no main json.
+    [[nodiscard]] auto referenceName() const -> std::string;
+};
+
+[[nodiscard]] auto findStoryFiles(ObbArchive const& archive) -> StoryFiles;
+
+// Contents of a stored entry, without copying; nullopt if it is compressed.
+[[nodiscard]] __attribute__((pure)) auto entryView(
+        ObbEntry const& entry) noexcept -> std::optional<std::string_view>;
+// Decompressed contents of an entry. Throws bad_obb if the data is corrupt.
+[[nodiscard]] auto readEntry(ObbEntry const& entry) -> std::string;
+// Reads length bytes of an entry starting at offset. Compressed entries only
+// inflate up to the end of the range, and from the last of the checkpoints
+// (such as those in an InflateIndex) before offset rather than from the start.
+// Throws bad_obb if the range is outside of the entry or the data is corrupt.
+[[nodiscard]] auto readEntryRange(
+        ObbEntry const& entry, size_t offset, size_t length,
+        std::vector<InflateCheckpoint> const* checkpoints = nullptr)
+        -> std::string;
+// Pretty-prints JSON the same way xtractobb does for .json, .minjson and
+// .inkcontent files.
+[[nodiscard]] auto formatJson(std::string_view json) -> std::string;
+// Builds the pretty-printed reference file, as xtractobb extracts it. Throws
+// bad_obb if story.hasReference() is false or the data is corrupt.
+[[nodiscard]] auto readReference(StoryFiles const& story) -> std::string;
+// Builds a single stitch, pretty-printed as it appears in the reference file,
+// or nothing if there is no stitch by that name. The main json is only read
+// as far as the stitch's range, and the inkcontent only as far as the end of
+// the stitch, so this is much faster than building the reference; with
+// checkpoints for a compressed inkcontent, only the part around the stitch is
+// inflated. Throws bad_obb if story.hasReference() is false or the data is
+// corrupt.
+[[nodiscard]] auto readStitch(
+        StoryFiles const& story, std::string_view name,
+        std::vector<InflateCheckpoint> const* inkCheckpoints = nullptr)
+        -> std::optional<std::string>;
+
+// Reads the contents of an entry incrementally, so that large entries need
+// not be decompressed into memory all at once.
+class EntryReader {
+public:
+    explicit EntryReader(ObbEntry const& _entry);
+
+    // Fills up to length bytes of output, and returns the amount written; zero
+    // once the whole entry was read. Throws bad_obb if the data is corrupt.
+    [[nodiscard]] auto read(char* output, size_t length) -> size_t;
+    [[nodiscard]] auto size() const noexcept -> size_t {
+        return entry.fulllength;
+    }
+    [[nodiscard]] auto position() const noexcept -> size_t {
+        return offset;
+    }
+
+private:
+    ObbEntry                     entry;
+    size_t                       offset = 0;
+    std::optional<InflateStream> inflater;
+};
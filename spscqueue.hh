@@ -0,0 +1,61 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+// Bounded queue between one producer thread and one consumer thread. Each
+// side sleeps while the queue is full or empty, and is woken by the other.
+template <typename T, size_t Capacity>
+class SpscQueue {
+public:
+    static_assert(Capacity >= 1, "SpscQueue needs at least one slot");
+
+    // Producer only; waits for room.
+    void push(T value) {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        notFull.wait(lock, [this]() { return count != Capacity; });
+        slots[(head + count) % Capacity] = std::move(value);
+        count++;
+        lock.unlock();
+        notEmpty.notify_one();
+    }
+    // Consumer only; waits for an element.
+    [[nodiscard]] auto pop() -> T {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        notEmpty.wait(lock, [this]() { return count != 0; });
+        T value = std::move(slots[head]);
+        head    = (head + 1) % Capacity;
+        count--;
+        lock.unlock();
+        notFull.notify_one();
+        return value;
+    }
+
+private:
+    std::mutex              queueMutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+    size_t                  head  = 0;
+    size_t                  count = 0;
+    std::array<T, Capacity> slots{};
+};
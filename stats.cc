@@ -0,0 +1,88 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stats.hh"
+
+#include "jsonstring.hh"
+
+#include <iomanip>
+#include <sstream>
+
+using std::string;
+using std::string_view;
+
+using namespace std::literals::string_view_literals;
+
+namespace {
+    constexpr double const BytesPerMB = 1000000.0;
+}    // namespace
+
+auto StatsReport::format() const -> string {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(6);
+
+    out << "{\n    \"tool\": "sv;
+    printJsonString(out, tool);
+    out << ",\n    \"phases\": {"sv;
+    double wallSeconds = 0.0;
+    char const* separator = "\n";
+    for (auto const& [name, seconds] : phases) {
+        out << separator << "        "sv;
+        printJsonString(out, name);
+        out << ": "sv << seconds;
+        wallSeconds += seconds;
+        separator = ",\n";
+    }
+    out << "\n    },\n"sv;
+
+    uint64_t complength   = 0U;
+    uint64_t fulllength   = 0U;
+    double   entrySeconds = 0.0;
+    for (auto const& elem : entries) {
+        complength += elem.complength;
+        fulllength += elem.fulllength;
+        entrySeconds += elem.seconds;
+    }
+    // Throughput is over the whole run, not just the time spent on files.
+    double const compressedRate
+            = wallSeconds > 0.0 ? complength / BytesPerMB / wallSeconds : 0.0;
+    double const uncompressedRate
+            = wallSeconds > 0.0 ? fulllength / BytesPerMB / wallSeconds : 0.0;
+    out << "    \"totals\": {\n"sv
+        << "        \"files\": "sv << entries.size() << ",\n"sv
+        << "        \"compressed_bytes\": "sv << complength << ",\n"sv
+        << "        \"uncompressed_bytes\": "sv << fulllength << ",\n"sv
+        << "        \"wall_seconds\": "sv << wallSeconds << ",\n"sv
+        << "        \"file_seconds\": "sv << entrySeconds << ",\n"sv
+        << "        \"compressed_mb_per_second\": "sv << compressedRate
+        << ",\n"sv
+        << "        \"uncompressed_mb_per_second\": "sv << uncompressedRate
+        << "\n    },\n"sv;
+
+    out << "    \"files\": ["sv;
+    separator = "\n";
+    for (auto const& elem : entries) {
+        out << separator << "        {\"name\": "sv;
+        printJsonString(out, elem.name);
+        out << ", \"compressed_bytes\": "sv << elem.complength
+            << ", \"uncompressed_bytes\": "sv << elem.fulllength
+            << ", \"seconds\": "sv << elem.seconds << '}';
+        separator = ",\n";
+    }
+    out << "\n    ]\n}\n"sv;
+    return out.str();
+}
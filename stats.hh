@@ -0,0 +1,88 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Measures wall-clock time.
+class Stopwatch {
+public:
+    Stopwatch() noexcept : start(clock::now()) {}
+
+    // Seconds since construction or the last lap.
+    [[nodiscard]] auto elapsed() const noexcept -> double {
+        return std::chrono::duration<double>(clock::now() - start).count();
+    }
+    // Returns the elapsed time, and starts measuring again.
+    auto lap() noexcept -> double {
+        auto const   now   = clock::now();
+        double const value = std::chrono::duration<double>(now - start).count();
+        start              = now;
+        return value;
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+    clock::time_point start;
+};
+
+// What it took to process a file.
+struct EntryStats {
+    std::string name;
+    uint64_t    complength = 0U;
+    uint64_t    fulllength = 0U;
+    double      seconds    = 0.0;
+};
+
+// Timings of a run, for --stats. The report is a JSON object with the wall
+// time of each phase, in order, the size and processing time of each file,
+// and totals with the aggregate throughput over the whole run.
+class StatsReport {
+public:
+    explicit StatsReport(std::string _tool) : tool(std::move(_tool)) {}
+
+    // The name must outlive the report.
+    void addPhase(std::string_view name, double seconds) {
+        phases.emplace_back(name, seconds);
+    }
+    // Makes room for count more files, returning the index of the first;
+    // workers can then each fill in their own files without locking.
+    [[nodiscard]] auto reserveEntries(size_t count) -> size_t {
+        size_t const first = entries.size();
+        entries.resize(first + count);
+        return first;
+    }
+    [[nodiscard]] auto entry(size_t index) noexcept -> EntryStats& {
+        return entries[index];
+    }
+    void addEntry(EntryStats stats) {
+        entries.push_back(std::move(stats));
+    }
+
+    [[nodiscard]] auto format() const -> std::string;
+
+private:
+    std::string                                      tool;
+    std::vector<std::pair<std::string_view, double>> phases;
+    std::vector<EntryStats>                          entries;
+};
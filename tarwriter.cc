@@ -0,0 +1,157 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tarwriter.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+
+using std::array;
+using std::lock_guard;
+using std::mutex;
+using std::string;
+using std::string_view;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+namespace {
+    using Block = array<char, TarWriter::BlockSize>;
+
+    // Header field offsets and sizes, as per POSIX ustar.
+    constexpr size_t const NameOffset     = 0;
+    constexpr size_t const NameSize       = 100;
+    constexpr size_t const ModeOffset     = 100;
+    constexpr size_t const UidOffset      = 108;
+    constexpr size_t const GidOffset      = 116;
+    constexpr size_t const SizeOffset     = 124;
+    constexpr size_t const MtimeOffset    = 136;
+    constexpr size_t const ChecksumOffset = 148;
+    constexpr size_t const TypeOffset     = 156;
+    constexpr size_t const MagicOffset    = 257;
+    constexpr size_t const VersionOffset  = 263;
+    constexpr size_t const PrefixOffset   = 345;
+    constexpr size_t const PrefixSize     = 155;
+
+    void putString(Block& block, size_t offset, string_view value) {
+        std::copy(value.cbegin(), value.cend(), block.begin() + offset);
+    }
+
+    // Numeric fields are zero-padded octal, with a terminating NUL.
+    void putOctal(Block& block, size_t offset, size_t width, uint64_t value) {
+        block[offset + width - 1] = '\0';
+        for (size_t ii = width - 1; ii > 0; ii--) {
+            block[offset + ii - 1] = static_cast<char>('0' + (value & 7U));
+            value >>= 3U;
+        }
+    }
+
+    // Splits name into ustar prefix and name fields. Returns false if there
+    // is no '/' at which the name can be split so that both parts fit.
+    auto splitName(string_view name, string_view& prefix, string_view& base)
+            -> bool {
+        if (name.size() <= NameSize) {
+            prefix = {};
+            base   = name;
+            return true;
+        }
+        size_t slash = name.rfind('/', PrefixSize);
+        while (slash != string_view::npos && slash != 0) {
+            if (name.size() - slash - 1 <= NameSize) {
+                prefix = name.substr(0, slash);
+                base   = name.substr(slash + 1);
+                return true;
+            }
+            slash = name.rfind('/', slash - 1);
+        }
+        return false;
+    }
+}    // namespace
+
+void TarWriter::writeHeader(string_view name, size_t size, char typeflag) {
+    Block block{};
+    putString(block, NameOffset, name.substr(0, NameSize));
+    putOctal(block, ModeOffset, 8, 0644U);
+    putOctal(block, UidOffset, 8, 0U);
+    putOctal(block, GidOffset, 8, 0U);
+    putOctal(block, SizeOffset, 12, size);
+    putOctal(block, MtimeOffset, 12, static_cast<uint64_t>(mtime));
+    block[TypeOffset] = typeflag;
+    putString(block, MagicOffset, "ustar"sv);
+    putString(block, VersionOffset, "00"sv);
+
+    string_view prefix;
+    string_view base;
+    if (splitName(name, prefix, base)) {
+        std::fill_n(block.begin() + NameOffset, NameSize, '\0');
+        putString(block, NameOffset, base);
+        putString(block, PrefixOffset, prefix);
+    }
+
+    // The checksum is computed with the checksum field set to spaces.
+    std::fill_n(block.begin() + ChecksumOffset, 8, ' ');
+    unsigned checksum = 0;
+    for (char const chr : block) {
+        checksum += static_cast<unsigned char>(chr);
+    }
+    putOctal(block, ChecksumOffset, 7, checksum);
+    out.write(block.data(), block.size());
+}
+
+void TarWriter::writeData(string_view contents) {
+    out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    size_t const tail = contents.size() % BlockSize;
+    if (tail != 0) {
+        constexpr static Block const padding{};
+        out.write(
+                padding.data(), static_cast<std::streamsize>(BlockSize - tail));
+    }
+}
+
+void TarWriter::addFile(string_view name, string_view contents) {
+    lock_guard<mutex> lock(tarMutex);
+    if (!out.good()) {
+        return;
+    }
+    string_view prefix;
+    string_view base;
+    if (!splitName(name, prefix, base)) {
+        // pax records are "<length> path=<name>\n", where the length counts
+        // itself, so it has to be found by iteration.
+        string const record = " path="s + string(name) + '\n';
+        size_t       length = record.size() + 1;
+        while (std::to_string(length).size() + record.size() != length) {
+            length = std::to_string(length).size() + record.size();
+        }
+        string const paxData = std::to_string(length) + record;
+        writeHeader("././@PaxHeader"sv, paxData.size(), 'x');
+        writeData(paxData);
+    }
+    writeHeader(name, contents.size(), '0');
+    writeData(contents);
+}
+
+auto TarWriter::finish() -> bool {
+    lock_guard<mutex> lock(tarMutex);
+    constexpr static Block const padding{};
+    out.write(padding.data(), padding.size());
+    out.write(padding.data(), padding.size());
+    out.flush();
+    return out.good();
+}
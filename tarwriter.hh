@@ -0,0 +1,48 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <ctime>
+#include <mutex>
+#include <ostream>
+#include <string_view>
+
+// Writes a POSIX (ustar) tar stream. Names that do not fit into the ustar
+// name and prefix fields get a pax extended header. Adding files is
+// thread-safe; each file is written as a whole, so members never interleave.
+// Once the stream fails, nothing more is written to it.
+class TarWriter {
+public:
+    static constexpr size_t const BlockSize = 512;
+
+    TarWriter(std::ostream& _out, std::time_t _mtime) noexcept
+            : out(_out), mtime(_mtime) {}
+
+    void addFile(std::string_view name, std::string_view contents);
+    // Writes the end-of-archive marker and flushes the stream. Returns false
+    // if any of the archive could not be written.
+    [[nodiscard]] auto finish() -> bool;
+
+private:
+    void writeHeader(std::string_view name, size_t size, char typeflag);
+    void writeData(std::string_view contents);
+
+    std::ostream& out;
+    std::time_t   mtime;
+    std::mutex    tarMutex;
+};
@@ -0,0 +1,102 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "codec.hh"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+using namespace std::literals::string_view_literals;
+
+void testInflate() {
+    string const text       = makeText(300000);
+    string const compressed = deflateInto(text, 9);
+    string       output(text.size(), '\0');
+    check(inflateInto(compressed, output.data(), output.size())
+                          == InflateStatus::eOK
+                  && output == text,
+          "inflate round trip");
+    check(inflateInto(compressed, output.data(), output.size() - 1)
+                  == InflateStatus::eSIZE_MISMATCH,
+          "inflating into too small a buffer");
+    string larger(text.size() + 1, '\0');
+    check(inflateInto(compressed, larger.data(), larger.size())
+                  == InflateStatus::eSIZE_MISMATCH,
+          "inflating into too large a buffer");
+    string const empty = deflateInto(string(), 9);
+    check(inflateInto(empty, nullptr, 0) == InflateStatus::eOK,
+          "inflating an empty stream");
+    string corrupt = compressed;
+    corrupt.back() ^= '\x55';
+    check(inflateInto(corrupt, output.data(), output.size())
+                  == InflateStatus::eDATA_ERROR,
+          "inflating data with a bad checksum");
+    check(inflateInto(string_view(compressed).substr(0, compressed.size() / 2),
+                      output.data(), output.size())
+                  != InflateStatus::eOK,
+          "inflating truncated data");
+}
+
+void testCodecBackends() {
+    string const text = makeText(300000);
+    check(deflateInto(text, 9) == deflateInto(text, 9, CodecBackend::eZlib),
+          "zlib is the default for deflating");
+    check(findCodecBackend("zlib"sv) == CodecBackend::eZlib,
+          "zlib is always built in");
+    check(!findCodecBackend("zstd"sv), "unknown backends are not found");
+
+    vector<CodecBackend> backends;
+    for (auto const name : {"zlib"sv, "zlib-ng"sv, "libdeflate"sv}) {
+        if (auto const backend = findCodecBackend(name); backend) {
+            check(codecBackendName(*backend) == name,
+                  string(name) + " backend keeps its name");
+            backends.push_back(*backend);
+        }
+    }
+
+    CodecBackend const previous = codecBackend();
+    for (CodecBackend const packer : backends) {
+        string const packed = deflateInto(text, 6, packer);
+        string corrupt      = packed;
+        corrupt.back() ^= '\x55';
+        for (CodecBackend const unpacker : backends) {
+            string const pair = string(codecBackendName(packer)) + " to "
+                                + string(codecBackendName(unpacker));
+            setCodecBackend(unpacker);
+            string unpacked(text.size(), '\0');
+            check(inflateInto(packed, unpacked.data(), unpacked.size())
+                                  == InflateStatus::eOK
+                          && unpacked == text,
+                  pair + " round trip");
+            check(inflateInto(packed, unpacked.data(), unpacked.size() - 1)
+                          == InflateStatus::eSIZE_MISMATCH,
+                  pair + " into too small a buffer");
+            check(inflateInto(corrupt, unpacked.data(), unpacked.size())
+                          != InflateStatus::eOK,
+                  pair + " with a bad checksum");
+        }
+    }
+    setCodecBackend(previous);
+    check(codecBackend() == previous, "codec backend is restored");
+}
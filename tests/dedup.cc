@@ -0,0 +1,99 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "codec.hh"
+#include "fileio.hh"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <string_view>
+
+using std::string;
+using std::string_view;
+
+using boost::filesystem::path;
+
+using namespace std::literals::string_literals;
+
+namespace {
+    auto contentsOf(OutputTree const& tree, path const& name) -> string {
+        InputMapping const input(tree, name);
+        return input.valid() ? string(input.view()) : string();
+    }
+}    // namespace
+
+void testCloneFile(path const& tmpdir) {
+    path const dir = tmpdir / "clone";
+    create_directories(dir);
+    OutputTree const tree(dir);
+    string const     text = makeText(10000);
+    writeFile(dir / "source.txt", text);
+
+    check(tree.cloneFile("source.txt", "clone.txt")
+                  && contentsOf(tree, "clone.txt") == text,
+          "cloned file has the contents of its source");
+    writeFile(dir / "existing.txt", "something else"s);
+    check(tree.cloneFile("source.txt", "existing.txt")
+                  && contentsOf(tree, "existing.txt") == text,
+          "cloning replaces an existing file");
+    check(!tree.cloneFile("missing.txt", "other.txt")
+                  && !exists(dir / "other.txt"),
+          "cloning a missing file fails");
+    check(contentsOf(tree, "source.txt") == text,
+          "cloning leaves the source alone");
+}
+
+void testDedup(path const& tmpdir, path const& xtractobb) {
+    path const   dir        = tmpdir / "dedup";
+    string const text       = makeText(50000);
+    string const compressed = deflateInto(text, 9);
+    auto const   fulllength = static_cast<uint32_t>(text.size());
+    create_directories(dir);
+    writeObb(dir / "dups.obb",
+             {{"a/first.txt"s, compressed, fulllength},
+              {"b/second.txt"s, compressed, fulllength},
+              {"stored1.txt"s, "same stored bytes"s, 17U},
+              {"stored2.txt"s, "same stored bytes"s, 17U},
+              {"other.txt"s, "other stored bytes"s, 18U}});
+
+    path const linked = dir / "linked";
+    check(runProgram(xtractobb, {(dir / "dups.obb").string(), linked.string()})
+                  == 0,
+          "OBB with duplicates is extracted");
+    OutputTree const tree(linked);
+    check(contentsOf(tree, "a/first.txt") == text
+                  && contentsOf(tree, "b/second.txt") == text,
+          "duplicate compressed entries are extracted");
+    check(contentsOf(tree, "stored1.txt") == "same stored bytes"s
+                  && contentsOf(tree, "stored2.txt") == "same stored bytes"s
+                  && contentsOf(tree, "other.txt") == "other stored bytes"s,
+          "duplicate stored entries are extracted");
+
+    path const copied = dir / "copied";
+    check(runProgram(
+                  xtractobb,
+                  {"--no-dedup"s, (dir / "dups.obb").string(), copied.string()})
+                  == 0,
+          "OBB with duplicates is extracted without dedup");
+    check(!equivalent(copied / "a/first.txt", copied / "b/second.txt")
+                  && !equivalent(
+                          copied / "stored1.txt", copied / "stored2.txt"),
+          "--no-dedup writes each duplicate separately");
+}
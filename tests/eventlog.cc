@@ -0,0 +1,124 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "eventlog.hh"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <unistd.h>
+
+#include <array>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+using boost::filesystem::path;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+namespace {
+    auto readFile(path const& fname) -> string {
+        boost::filesystem::ifstream fin(fname, std::ios::in | std::ios::binary);
+        string contents(file_size(fname), '\0');
+        fin.read(
+                contents.data(),
+                static_cast<std::streamsize>(contents.size()));
+        return contents;
+    }
+}    // namespace
+
+void testEventLog(path const& tmpdir) {
+    path const logfile = tmpdir / "events.ndjson";
+    auto       events  = EventLog::open(logfile.string());
+    check(events != nullptr, "event log opens a path");
+    if (!events) {
+        return;
+    }
+    events->file("written"sv, "a/b.json"sv, tmpdir / "out/a/b.json");
+    check(readFile(logfile)
+                  == R"({"event":"file","status":"written","name":"a/b.json",)"
+                     R"("path":")"s
+                             + (tmpdir / "out/a/b.json").string() + "\"}\n"s,
+          "file event line, written at once");
+    events->file("failed"sv, "q\"b\\s\tt"sv, path("x"));
+    events->done(path("in.obb"), path("out"));
+    events.reset();
+    check(readFile(logfile)
+                  == R"({"event":"file","status":"written","name":"a/b.json",)"
+                     R"("path":")"s
+                             + (tmpdir / "out/a/b.json").string()
+                             + "\"}\n"s
+                               R"({"event":"file","status":"failed",)"
+                               R"("name":"q\"b\\s\u0009t","path":"x"})"
+                               "\n"
+                               R"({"event":"done","obb":"in.obb","path":"out"})"
+                               "\n"s,
+          "event lines escape names, and end with a newline");
+
+    check(EventLog::open((tmpdir / "missing/events").string()) == nullptr,
+          "event log fails to open a path in a missing directory");
+
+    // Lines from several threads are whole, even through a descriptor.
+    std::array<int, 2> pipe{};
+    if (::pipe(pipe.data()) != 0) {
+        check(false, "event log test pipe");
+        return;
+    }
+    constexpr size_t const NumThreads = 4;
+    constexpr size_t const NumEvents  = 100;
+    {
+        auto shared = EventLog::open(std::to_string(pipe[1]));
+        check(shared != nullptr, "event log opens a descriptor");
+        if (shared) {
+            vector<std::thread> threads;
+            for (size_t ii = 0; ii < NumThreads; ii++) {
+                threads.emplace_back([&shared]() {
+                    for (size_t jj = 0; jj < NumEvents; jj++) {
+                        shared->file("written"sv, "name"sv, path("path"));
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+    }
+    ::close(pipe[1]);
+    string                 contents;
+    std::array<char, 4096> buffer{};
+    ssize_t                length = 0;
+    while ((length = ::read(pipe[0], buffer.data(), buffer.size())) > 0) {
+        contents.append(buffer.data(), static_cast<size_t>(length));
+    }
+    ::close(pipe[0]);
+    string const line
+            = R"({"event":"file","status":"written","name":"name",)"
+              R"("path":"path"})"
+              "\n"s;
+    string expected;
+    for (size_t ii = 0; ii < NumThreads * NumEvents; ii++) {
+        expected += line;
+    }
+    check(contents == expected, "event lines from threads are whole");
+}
@@ -0,0 +1,75 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "fileindex.hh"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+void testFileIndex() {
+    string const                    names = "firstsecond/file.jsonthird"s;
+    vector<FileIndex::Record> const records{
+            {string_view(names).substr(0, 5), 16U, 100U, 300U, true, true,
+             0x0123456789abcdefU},
+            {string_view(names).substr(5, 16), 116U, 50U, 50U, false,
+             false, 0U},
+            {string_view(names).substr(21), 166U, 0U, 0U, false, true,
+             0xfedcba9876543210U}};
+    string const data = FileIndex::format(records);
+    check(FileIndex::isIndex(data), "file index has its signature");
+    check(data.size()
+                  == FileIndex::HeaderSize
+                             + records.size() * FileIndex::RecordSize
+                             + names.size(),
+          "file index size");
+    FileIndex const index(data);
+    check(index.size() == records.size(), "file index record count");
+    for (size_t ii = 0; ii < records.size(); ii++) {
+        FileIndex::Record const record = index[ii];
+        check(record.name == records[ii].name
+                      && record.offset == records[ii].offset
+                      && record.complength == records[ii].complength
+                      && record.fulllength == records[ii].fulllength
+                      && record.compressed == records[ii].compressed
+                      && record.hasChecksum == records[ii].hasChecksum
+                      && record.checksum == records[ii].checksum,
+              "file index record " + std::to_string(ii) + " round trip");
+    }
+    check(FileIndex::format({}) == FileIndex::format({}),
+          "file index format is deterministic");
+    check(FileIndex(FileIndex::format({})).size() == 0,
+          "empty file index");
+    check(!FileIndex::isIndex("AP_Pack!"sv), "OBB is not a file index");
+    check(throwsRuntimeError([&]() {
+              FileIndex const bad(string_view(data).substr(0, 40));
+          }),
+          "truncated file index is rejected");
+    string wrongVersion = data;
+    wrongVersion[8]     = '\x7f';
+    check(throwsRuntimeError([&]() { FileIndex const bad(wrongVersion); }),
+          "file index of another version is rejected");
+}
@@ -0,0 +1,64 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "fileio.hh"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+using std::string;
+using std::string_view;
+
+using boost::filesystem::path;
+
+void testOutputMapping(path const& tmpdir) {
+    OutputTree const tree(tmpdir);
+    string const     text = makeText(100000);
+    {
+        OutputMapping mapping(tree, "mapped.txt", text.size());
+        check(mapping.valid() && mapping.size() == text.size(),
+              "output mapping is created");
+        if (mapping.valid()) {
+            std::copy(text.cbegin(), text.cend(), mapping.data());
+            check(mapping.commit(), "output mapping is committed");
+        }
+    }
+    {
+        InputMapping const input(tree, "mapped.txt");
+        check(input.valid() && input.view() == string_view(text),
+              "output mapping contents");
+    }
+    {
+        OutputMapping const mapping(tree, "dropped.txt", text.size());
+    }
+    check(!exists(tmpdir / "dropped.txt"),
+          "output mapping is removed unless committed");
+    {
+        // Space that cannot be reserved must fail here, rather than leave a
+        // sparse file that fails with SIGBUS once it is written to.
+        FileSizeLimit const limit(4096U);
+        OutputMapping const mapping(tree, "toolarge.txt", text.size());
+        check(!mapping.valid(), "output mapping fails without space");
+    }
+    check(!exists(tmpdir / "toolarge.txt"),
+          "output mapping that failed is removed");
+}
@@ -0,0 +1,49 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "hash.hh"
+
+#include <string>
+#include <string_view>
+
+using std::string;
+using std::string_view;
+
+using namespace std::literals::string_view_literals;
+
+void testHash() {
+    // Reference values of XXH64.
+    check(hashData(""sv) == 0xef46db3751d8e999U, "XXH64 of empty input");
+    check(hashData("a"sv) == 0xd24ec4f1a98c6e5bU, "XXH64 of \"a\"");
+    check(hashData("abc"sv) == 0x44bc2cf5ad770999U, "XXH64 of \"abc\"");
+    check(hashData("Nobody inspects the spammish repetition"sv)
+                  == 0xfbcea83c8a378bf1U,
+          "XXH64 of a 39-byte string");
+    check(hashData("abcdefghijklmnopqrstuvwxyz012345"sv, 1U)
+                  == 0x1476a5fc111cb8f4U,
+          "XXH64 of 32 bytes with seed 1");
+    string bytes;
+    for (size_t ii = 0; ii < 768; ii++) {
+        bytes += static_cast<char>(ii & 0xffU);
+    }
+    check(hashData(bytes) == 0x8e03c838c596036fU, "XXH64 of 768 bytes");
+    check(hashData(string_view(bytes).substr(0, 100), 0x9E3779B97F4A7C15U)
+                  == 0x3b97d91eba03e785U,
+          "XXH64 of 100 bytes with a 64-bit seed");
+}
@@ -0,0 +1,150 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "codec.hh"
+#include "inflateindex.hh"
+#include "sorceryobb.hh"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+using boost::filesystem::path;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+void testInflateIndexed() {
+    string const text       = makeText(300000);
+    string const compressed = deflateInto(text, 9);
+
+    constexpr size_t const    span = 16384;
+    vector<InflateCheckpoint> checkpoints;
+    string                    indexed(text.size(), '\0');
+    check(inflateIndexed(
+                  compressed, indexed.data(), indexed.size(), span, checkpoints)
+                          == InflateStatus::eOK
+                  && indexed == text,
+          "indexed inflate round trip");
+    check(checkpoints.size() > 1, "indexed inflate records checkpoints");
+    for (size_t const offset :
+         {size_t{0}, size_t{1}, span, text.size() / 2,
+          text.size() - 1000}) {
+        string range(1000, '\0');
+        check(inflateRange(
+                      compressed, text.size(), checkpoints, offset,
+                      range.data(), range.size())
+                              == InflateStatus::eOK
+                      && range == text.substr(offset, range.size()),
+              "range at " + std::to_string(offset));
+        check(inflateRange(
+                      compressed, text.size(), {}, offset, range.data(),
+                      range.size())
+                              == InflateStatus::eOK
+                      && range == text.substr(offset, range.size()),
+              "range at " + std::to_string(offset)
+                      + " without checkpoints");
+    }
+    string range(10, '\0');
+    check(inflateRange(
+                  compressed, text.size(), checkpoints, text.size() - 5,
+                  range.data(), range.size())
+                  == InflateStatus::eSIZE_MISMATCH,
+          "range past the end is rejected");
+}
+
+void testInflateIndex(path const& tmpdir) {
+    string const text       = makeText(200000);
+    string const compressed = deflateInto(text, 9);
+    auto const   length     = static_cast<uint32_t>(text.size());
+    path const   obbfile    = tmpdir / "test.obb";
+    writeObb(obbfile,
+             {{"a/big.txt"s, compressed, length},
+              {"b/small.txt"s, "stored data"s, 11U}});
+    ObbArchive const archive = openArchive(obbfile);
+    check(archive.size() == 2, "OBB entry count");
+    auto const big   = archive.find("a/big.txt"sv);
+    auto const small = archive.find("b/small.txt"sv);
+    check(big && small && !archive.find("c"sv), "OBB lookup by name");
+    if (!big || !small) {
+        return;
+    }
+    check(big->compressed() && !small->compressed(),
+          "OBB entry compression");
+    check(readEntryRange(*small, 7, 4) == "data"sv,
+          "range of a stored entry");
+    check(readEntryRange(*big, 150000, 100) == text.substr(150000, 100),
+          "range of a compressed entry");
+
+    vector<InflateCheckpoint> checkpoints;
+    string                    output(text.size(), '\0');
+    check(inflateIndexed(
+                  big->data, output.data(), output.size(), 16384, checkpoints)
+                  == InflateStatus::eOK,
+          "indexed inflate of an entry");
+    check(readEntryRange(*big, 150000, 100, &checkpoints)
+                  == text.substr(150000, 100),
+          "range of a compressed entry with checkpoints");
+
+    InflateIndex index;
+    index.add(archive, *big, checkpoints);
+    index.add(archive, *small, {});
+    check(index.size() == 1, "entries without checkpoints are left out");
+    string const data = index.format();
+    check(InflateIndex::isIndex(data), "inflate index has its signature");
+    InflateIndex parsed(data);
+    check(parsed.format() == data, "inflate index round trip");
+    auto const* found = parsed.find(archive, *big);
+    check(found != nullptr && found->size() == checkpoints.size(),
+          "inflate index lookup");
+    if (found != nullptr) {
+        bool same = found->size() == checkpoints.size();
+        for (size_t ii = 0; same && ii < found->size(); ii++) {
+            auto const& lhs = (*found)[ii];
+            auto const& rhs = checkpoints[ii];
+            same = lhs.outOffset == rhs.outOffset
+                   && lhs.inOffset == rhs.inOffset && lhs.bits == rhs.bits
+                   && lhs.window == rhs.window;
+        }
+        check(same, "inflate index checkpoints round trip");
+    }
+    check(parsed.find(archive, *small) == nullptr,
+          "inflate index has no record for other entries");
+    check(throwsRuntimeError([&]() {
+              InflateIndex const bad(string_view(data).substr(0, 60));
+          }),
+          "truncated inflate index is rejected");
+
+    // The same entry in a different OBB must not match.
+    path const otherfile = tmpdir / "other.obb";
+    writeObb(otherfile,
+             {{"0"s, "x"s, 1U}, {"a/big.txt"s, compressed, length}});
+    ObbArchive const other      = openArchive(otherfile);
+    auto const       movedEntry = other.find("a/big.txt"sv);
+    check(movedEntry && parsed.find(other, *movedEntry) == nullptr,
+          "inflate index ignores moved entries");
+    parsed.retain(other);
+    check(parsed.size() == 0, "retain drops records of moved entries");
+}
@@ -0,0 +1,110 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "codec.hh"
+#include "jsonpipeline.hh"
+#include "prettyJson.hh"
+
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+namespace {
+    // A JSON document of at least the given size, with strings holding
+    // escapes and the characters that JSON tokens are cut after.
+    auto makeJson(size_t length) -> string {
+        string json = "{\"items\": ["s;
+        for (size_t ii = 0; json.size() < length; ii++) {
+            if (ii != 0) {
+                json += ", "sv;
+            }
+            json += "{\"id\": "s + std::to_string(ii)
+                    + ", \"name\": \"item \\\"" + std::to_string(ii)
+                    + "\\\", with, commas {[ and a \\\\\", "
+                      "\"values\": [1, 2.5, -3e2, true, false, null], "
+                      "\"nested\": {\"empty\": {}, \"list\": []}}"s;
+        }
+        return json + "]}"s;
+    }
+
+    auto prettyPrint(string_view json) -> string {
+        string result;
+        {
+            boost::iostreams::filtering_ostream fsout;
+            fsout.push(json_filter(ePRETTY));
+            fsout.push(boost::iostreams::back_inserter(result));
+            fsout.write(json.data(), static_cast<std::streamsize>(json.size()));
+        }
+        return result;
+    }
+}    // namespace
+
+void testJsonPipeline() {
+    string const json       = makeJson(3U * 1024U * 1024U);
+    string const expected   = prettyPrint(json);
+    string const compressed = deflateInto(json, 6);
+    auto const   fulllength = static_cast<uint32_t>(json.size());
+
+    std::ostringstream storedOut;
+    check(pipeJson({"stored.json"sv, json, fulllength}, storedOut)
+                          == InflateStatus::eOK
+                  && storedOut.str() == expected,
+          "pipelined stored JSON matches json_filter");
+
+    std::ostringstream        compressedOut;
+    vector<InflateCheckpoint> checkpoints;
+    check(pipeJson({"compressed.json"sv, compressed, fulllength},
+                   compressedOut, &checkpoints)
+                          == InflateStatus::eOK
+                  && compressedOut.str() == expected,
+          "pipelined compressed JSON matches json_filter");
+    check(!checkpoints.empty(), "pipelined JSON records checkpoints");
+
+    std::ostringstream small;
+    check(pipeJson({"small.json"sv, deflateInto("[1,{}]"sv, 6), 6U}, small)
+                          == InflateStatus::eOK
+                  && small.str() == prettyPrint("[1,{}]"sv),
+          "pipelined small JSON matches json_filter");
+
+    // The compressed data stops partway through the document.
+    string_view const  truncated = string_view(compressed).substr(
+            0, compressed.size() / 2);
+    std::ostringstream truncatedOut;
+    check(pipeJson({"truncated.json"sv, truncated, fulllength}, truncatedOut)
+                  != InflateStatus::eOK,
+          "pipelined JSON reports an inflate error partway through");
+
+    std::ostringstream failed;
+    failed.setstate(std::ios::badbit);
+    check(pipeJson({"compressed.json"sv, compressed, fulllength}, failed)
+                          == InflateStatus::eOK
+                  && failed.str().empty(),
+          "pipelined JSON leaves write errors in the stream");
+}
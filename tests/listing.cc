@@ -0,0 +1,128 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "codec.hh"
+#include "listing.hh"
+#include "namefilter.hh"
+#include "sorceryobb.hh"
+
+#include <boost/filesystem.hpp>
+
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+using boost::filesystem::path;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+namespace {
+    // The first column of a TSV listing, without the header.
+    auto namesOf(string const& listing) -> vector<string> {
+        std::istringstream input(listing);
+        string             line;
+        vector<string>     names;
+        std::getline(input, line);
+        while (std::getline(input, line)) {
+            names.push_back(line.substr(0, line.find('\t')));
+        }
+        return names;
+    }
+}    // namespace
+
+void testListing(path const& tmpdir) {
+    check(parseListOrder("ratio"sv) == ListOrder::eRatio,
+          "--sort key is parsed");
+    check(!parseListOrder("bogus"sv), "unknown --sort key is rejected");
+
+    string const compressed = deflateInto(makeText(1000), 9);
+    path const   obbfile    = tmpdir / "listing.obb";
+    writeObb(obbfile,
+             {{"a.txt"s, "0123456789"s, 10U},
+              {"b.json"s, compressed, 1000U},
+              {"c.png"s, "png"s, 3U},
+              {"d.txt"s, ""s, 0U}});
+    ObbArchive const obb = openArchive(obbfile);
+    NameFilter const all;
+    auto const       names = [&](ListOrder order, bool reverse) {
+        return namesOf(
+                formatListing(obb, all, order, reverse, ListFormat::eTSV));
+    };
+
+    string const listing = formatListing(
+            obb, all, ListOrder::eName, false, ListFormat::eTSV);
+    check(listing.substr(0, listing.find('\n'))
+                  == "name\toffset\tcompressed_bytes\tuncompressed_bytes\t"
+                     "ratio\tcompressed"s,
+          "TSV listing header");
+    check(listing.find("\na.txt\t16\t10\t10\t1.000000\tno\n"sv)
+                  != string::npos,
+          "TSV listing of a stored entry");
+    check(names(ListOrder::eName, false)
+                  == vector<string>{"a.txt", "b.json", "c.png", "d.txt"},
+          "listing by name");
+    check(names(ListOrder::eName, true)
+                  == vector<string>{"d.txt", "c.png", "b.json", "a.txt"},
+          "listing by name, reversed");
+    check(names(ListOrder::eSize, false)
+                  == vector<string>{"d.txt", "c.png", "a.txt", "b.json"},
+          "listing by size");
+    check(names(ListOrder::eCompressed, true)
+                  == vector<string>{"b.json", "a.txt", "c.png", "d.txt"},
+          "listing by compressed size, reversed");
+    check(names(ListOrder::eOffset, true)
+                  == vector<string>{"d.txt", "c.png", "b.json", "a.txt"},
+          "listing by offset, reversed");
+    // Ties keep table order, whichever the direction.
+    check(names(ListOrder::eRatio, false)
+                  == vector<string>{"b.json", "a.txt", "c.png", "d.txt"},
+          "listing by ratio");
+    check(names(ListOrder::eRatio, true)
+                  == vector<string>{"a.txt", "c.png", "d.txt", "b.json"},
+          "listing by ratio, reversed");
+
+    NameFilter filter;
+    filter.exclude("*.txt"sv);
+    check(namesOf(formatListing(
+                  obb, filter, ListOrder::eName, false, ListFormat::eTSV))
+                  == vector<string>{"b.json", "c.png"},
+          "listing is filtered");
+
+    NameFilter one;
+    one.include("c.png"sv);
+    check(formatListing(obb, one, ListOrder::eName, false, ListFormat::eJSON)
+                  == "[\n    {\"name\": \"c.png\", \"offset\": "s
+                             + std::to_string(26 + compressed.size())
+                             + ", \"compressed_bytes\": 3, "
+                               "\"uncompressed_bytes\": 3, "
+                               "\"ratio\": 1.000000, "
+                               "\"compressed\": false}\n]\n"s,
+          "JSON listing");
+    NameFilter none;
+    none.include("nothing"sv);
+    check(formatListing(obb, none, ListOrder::eName, false, ListFormat::eJSON)
+                  == "[]\n"s,
+          "empty JSON listing");
+}
@@ -0,0 +1,85 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "fileio.hh"
+#include "hash.hh"
+#include "manifest.hh"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <string_view>
+
+using std::string;
+using std::string_view;
+
+using boost::filesystem::path;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+void testManifest(path const& tmpdir) {
+    Manifest manifest;
+    manifest.emplace(
+            "a.json"s, ManifestRecord{16U, 100U, 300U, 0x1234U, 300U,
+                                      0xfedcba9876543210U});
+    manifest.emplace(
+            "dir/b c.txt"s, ManifestRecord{116U, 5U, 5U, 1U, 5U, 2U});
+    path const fname = tmpdir / "manifest";
+    writeFile(fname, formatManifest(manifest));
+    Manifest const loaded = loadManifest(fname);
+    bool           same   = loaded.size() == manifest.size();
+    for (auto const& [name, record] : manifest) {
+        auto const found = loaded.find(name);
+        same             = same && found != loaded.cend()
+               && found->second.sameSource(record)
+               && found->second.outputSize == record.outputSize
+               && found->second.outputHash == record.outputHash;
+    }
+    check(same, "manifest round trip");
+    check(loadManifest(tmpdir / "missing").empty(),
+          "missing manifest is empty");
+    writeFile(fname, formatManifest(manifest) + "12\tx\n"s);
+    check(loadManifest(fname).empty(), "corrupt manifest is empty");
+
+    // A file is up to date while its source and its contents are both
+    // what the previous run recorded.
+    string const         contents = "extracted contents"s;
+    ManifestRecord const source{16U, 10U, 18U, 0xabcdU};
+    ManifestRecord const written{
+            16U, 10U, 18U, 0xabcdU, contents.size(), hashData(contents)};
+    Manifest const   previous{{"file.txt"s, written}};
+    OutputTree const tree(tmpdir);
+    writeFile(tmpdir / "file.txt", contents);
+    check(findUpToDate(previous, "file.txt"sv, source, tree, "file.txt")
+                  .has_value(),
+          "unchanged file is up to date");
+    ManifestRecord moved = source;
+    moved.offset++;
+    check(!findUpToDate(previous, "file.txt"sv, moved, tree, "file.txt"),
+          "moved source is not up to date");
+    check(!findUpToDate(previous, "other.txt"sv, source, tree, "file.txt"),
+          "file missing from the manifest is not up to date");
+    writeFile(tmpdir / "file.txt", "edited contents!!!"sv);
+    check(!findUpToDate(previous, "file.txt"sv, source, tree, "file.txt"),
+          "edited file is not up to date");
+    boost::filesystem::remove(tmpdir / "file.txt");
+    check(!findUpToDate(previous, "file.txt"sv, source, tree, "file.txt"),
+          "deleted file is not up to date");
+}
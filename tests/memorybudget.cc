@@ -0,0 +1,126 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "memorybudget.hh"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+    // How long a thread that is not held up takes to get its share, at most.
+    constexpr auto const Settle = std::chrono::milliseconds(50);
+
+    // Takes cost out of the budget on a thread of its own, and holds it
+    // until told to give it back. Those which are held up must be destroyed
+    // after those holding them up.
+    class Taker {
+    public:
+        Taker(MemoryBudget& budget, size_t cost)
+                : worker([this, &budget, cost]() {
+                      MemoryBudget::Lease const lease(budget, cost);
+                      admitted = true;
+                      while (!done) {
+                          std::this_thread::sleep_for(Settle / 10);
+                      }
+                  }) {
+            std::this_thread::sleep_for(Settle);
+        }
+        Taker(Taker const&) = delete;
+        Taker(Taker&&)      = delete;
+        auto operator=(Taker const&) -> Taker& = delete;
+        auto operator=(Taker&&) -> Taker& = delete;
+        ~Taker() noexcept {
+            done = true;
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+
+        // Whether it got its share, giving it some time to.
+        [[nodiscard]] auto running() const -> bool {
+            for (int ii = 0; ii < 100 && !admitted; ii++) {
+                std::this_thread::sleep_for(Settle / 5);
+            }
+            return admitted;
+        }
+        // Whether it is still waiting for its share, as it should be.
+        [[nodiscard]] auto waiting() const noexcept -> bool {
+            return !admitted;
+        }
+        // Gives its share back, and waits for those it held up.
+        void finish() {
+            done = true;
+            worker.join();
+            std::this_thread::sleep_for(Settle);
+        }
+
+    private:
+        std::atomic<bool> admitted{false};
+        std::atomic<bool> done{false};
+        // Last, so that it starts once the flags are set up.
+        std::thread worker;
+    };
+}    // namespace
+
+void testMemoryBudget() {
+    {
+        MemoryBudget budget(0U);
+        budget.acquire(1000U);
+        budget.acquire(1000U);
+        check(!budget.enabled(), "memory budget of zero is disabled");
+    }
+    {
+        MemoryBudget budget(100U);
+        Taker        first(budget, 60U);
+        Taker        second(budget, 40U);
+        check(first.running() && second.running(),
+              "entries that fit the budget run together");
+        Taker third(budget, 10U);
+        check(third.waiting(), "entry waits while the budget is full");
+        second.finish();
+        check(third.running(), "entry starts once it fits the budget");
+    }
+    {
+        MemoryBudget budget(100U);
+        Taker        small(budget, 30U);
+        Taker        large(budget, 150U);
+        check(large.waiting(),
+              "entry larger than the budget waits for the others");
+        Taker later(budget, 10U);
+        check(later.waiting(),
+              "entries wait behind an entry larger than the budget");
+        small.finish();
+        check(large.running() && later.waiting(),
+              "entry larger than the budget runs alone");
+        large.finish();
+        check(later.running(), "entries run after the larger one");
+    }
+    {
+        MemoryBudget budget(100U);
+        budget.setAside(40U);
+        check(budget.capacity() == 60U, "set aside memory leaves the budget");
+        Taker first(budget, 60U);
+        Taker second(budget, 1U);
+        check(first.running() && second.waiting(),
+              "set aside memory is not handed out");
+        first.finish();
+        check(second.running(), "the rest of the budget is handed out");
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "namefilter.hh"
+
+#include <sstream>
+#include <string_view>
+
+using namespace std::literals::string_view_literals;
+
+void testGlobs() {
+    check(globMatch("*.json"sv, "a/b.json"sv), "'*' matches '/'");
+    check(!globMatch("*.json"sv, "a/b.jsonx"sv), "glob matches whole name");
+    check(globMatch("a?c"sv, "abc"sv), "'?' matches one character");
+    check(!globMatch("a?c"sv, "ac"sv), "'?' does not match nothing");
+    check(globMatch("[a-c]x"sv, "bx"sv), "range matches");
+    check(!globMatch("[a-c]x"sv, "dx"sv), "range does not match");
+    check(globMatch("[!a-c]x"sv, "dx"sv), "'!' negates a class");
+    check(globMatch("[^a-c]x"sv, "dx"sv), "'^' negates a class");
+    check(!globMatch("[!a-c]x"sv, "ax"sv), "negated class does not match");
+    check(globMatch("a[b"sv, "a[b"sv), "unterminated '[' is literal");
+    check(globMatch("*"sv, ""sv), "'*' matches nothing");
+    check(globMatch("**x*"sv, "abxcd"sv), "repeated '*'");
+    check(!globMatch(""sv, "a"sv), "empty pattern only matches nothing");
+
+    NameFilter filter;
+    filter.include("en/*"sv);
+    filter.exclude("*.png"sv);
+    check(filter.matches("en/strings.json"sv), "included name matches");
+    check(!filter.matches("en/icon.png"sv), "excluded name does not match");
+    check(!filter.matches("fr/strings.json"sv),
+          "other name does not match");
+
+    NameFilter everything;
+    check(everything.selectsAll() && everything.matches("any/name"sv),
+          "empty filter matches everything");
+
+    NameFilter regexes;
+    regexes.includeRegex("Sorcery[0-9]+\\.json"sv);
+    regexes.excludeRegex(".*4.*"sv);
+    check(regexes.matches("Sorcery12.json"sv), "regex matches whole name");
+    check(!regexes.matches("Sorcery1.json.bak"sv),
+          "regex does not match part of a name");
+    check(!regexes.matches("Sorcery4.json"sv), "excluded by regex");
+
+    std::istringstream list("a/one.txt\r\n\nb/two.txt\n");
+    NameFilter         listed;
+    listed.includeList(list);
+    check(listed.matches("a/one.txt"sv) && listed.matches("b/two.txt"sv),
+          "listed names match, with CR LF line ends");
+    check(!listed.matches("a/one"sv) && !listed.matches(""sv),
+          "only listed names match");
+}
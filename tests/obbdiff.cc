@@ -0,0 +1,139 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "codec.hh"
+#include "namefilter.hh"
+#include "obbdiff.hh"
+#include "sorceryobb.hh"
+
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+using boost::filesystem::path;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+namespace {
+    template <typename Entries, typename Name>
+    auto namesOf(Entries const& entries, Name const& name) -> vector<string> {
+        vector<string> names;
+        for (auto const& entry : entries) {
+            names.emplace_back(name(entry));
+        }
+        return names;
+    }
+
+    auto namesOf(vector<ObbEntry> const& entries) -> vector<string> {
+        return namesOf(entries, [](ObbEntry const& entry) {
+            return entry.name;
+        });
+    }
+
+    auto namesOf(vector<EntryPair> const& pairs) -> vector<string> {
+        return namesOf(pairs, [](EntryPair const& pair) {
+            return pair.older.name;
+        });
+    }
+}    // namespace
+
+void testSameContents() {
+    string const   text   = makeText(200000);
+    string const   edited = text.substr(0, 150000) + '#' + text.substr(150001);
+    string const   fast   = deflateInto(text, 1);
+    string const   best   = deflateInto(text, 9);
+    string const   other  = deflateInto(edited, 9);
+    auto const     length = static_cast<uint32_t>(text.size());
+    ObbEntry const stored{"file"sv, text, length};
+
+    check(sameContents({stored, {"file"sv, best, length}}),
+          "stored and compressed entries with the same contents are same");
+    check(sameContents({{"file"sv, best, length}, stored}),
+          "compressed and stored entries with the same contents are same");
+    check(sameContents({{"file"sv, fast, length}, {"file"sv, best, length}}),
+          "entries compressed at different levels are same");
+    check(!sameContents({{"file"sv, best, length}, {"file"sv, other, length}}),
+          "entries differing late in the file are different");
+    check(!sameContents({stored, {"file"sv, edited, length}}),
+          "stored entries with different contents are different");
+    string corrupt(best);
+    corrupt.back() ^= '\x55';
+    check(!sameContents({stored, {"file"sv, corrupt, length}}),
+          "entry with invalid compressed data is different");
+}
+
+void testCompareTables(path const& tmpdir) {
+    string const text     = makeText(5000);
+    string const edited   = text.substr(0, 4000) + '#' + text.substr(4001);
+    auto const   length   = static_cast<uint32_t>(text.size());
+    string const best     = deflateInto(text, 9);
+    string const fast     = deflateInto(text, 1);
+    string const modified = deflateInto(edited, 9);
+    writeObb(tmpdir / "older.obb",
+             {{"changed.txt"s, best, length},
+              {"common.txt"s, text, length},
+              {"gone.txt"s, "gone"s, 4U},
+              {"image.png"s, "old image"s, 9U},
+              {"level.txt"s, fast, length},
+              {"recompressed.txt"s, text, length},
+              {"resized.txt"s, "short"s, 5U},
+              {"stored.txt"s, "old stored"s, 10U}});
+    writeObb(tmpdir / "newer.obb",
+             {{"changed.txt"s, modified, length},
+              {"common.txt"s, text, length},
+              {"image.png"s, "new image"s, 9U},
+              {"level.txt"s, best, length},
+              {"new.txt"s, "new"s, 3U},
+              {"recompressed.txt"s, best, length},
+              {"resized.txt"s, "longer"s, 6U},
+              {"stored.txt"s, "new stored"s, 10U}});
+    ObbArchive const older = openArchive(tmpdir / "older.obb");
+    ObbArchive const newer = openArchive(tmpdir / "newer.obb");
+
+    NameFilter filter;
+    filter.exclude("*.png"sv);
+    ObbDiff const diff = compareTables(older, newer, filter);
+    check(namesOf(diff.added) == vector<string>{"new.txt"},
+          "diff finds added entries");
+    check(namesOf(diff.removed) == vector<string>{"gone.txt"},
+          "diff finds removed entries");
+    check(namesOf(diff.modified)
+                  == vector<string>{"resized.txt", "stored.txt"},
+          "diff finds modified entries without decompressing");
+    check(namesOf(diff.ambiguous)
+                  == vector<string>{
+                          "changed.txt", "level.txt", "recompressed.txt"},
+          "diff leaves compressed entries that differ to be decompressed");
+    check(diff.unchanged == 1, "diff counts unchanged entries");
+    if (diff.ambiguous.size() == 3) {
+        check(!sameContents(diff.ambiguous[0])
+                      && sameContents(diff.ambiguous[1])
+                      && sameContents(diff.ambiguous[2]),
+              "ambiguous entries are told apart by their contents");
+    }
+    check(compareTables(older, newer, NameFilter()).modified.size() == 3,
+          "diff of unfiltered names");
+}
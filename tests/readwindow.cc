@@ -0,0 +1,174 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "readwindow.hh"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace {
+    // An anonymous private mapping filled with nonzero bytes: dropped pages
+    // read back as zeros, which shows which pages the window dropped.
+    class TestMapping {
+    public:
+        explicit TestMapping(size_t _pages)
+                : pageSize(static_cast<size_t>(sysconf(_SC_PAGESIZE))),
+                  pages(_pages) {
+            void* result = ::mmap(
+                    nullptr, pages * pageSize, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (result != MAP_FAILED) {
+                base = static_cast<char*>(result);
+                std::memset(base, 'x', pages * pageSize);
+            }
+        }
+        TestMapping(TestMapping const&) = delete;
+        TestMapping(TestMapping&&)      = delete;
+        auto operator=(TestMapping const&) -> TestMapping& = delete;
+        auto operator=(TestMapping&&) -> TestMapping& = delete;
+        ~TestMapping() noexcept {
+            if (base != nullptr) {
+                ::munmap(base, pages * pageSize);
+            }
+        }
+
+        [[nodiscard]] auto valid() const noexcept -> bool {
+            return base != nullptr;
+        }
+        [[nodiscard]] auto view() const noexcept -> string_view {
+            return {base, pages * pageSize};
+        }
+        // The data of an entry taking up the given pages.
+        [[nodiscard]] auto pagesAt(size_t first, size_t count) const noexcept
+                -> string_view {
+            return {base + first * pageSize, count * pageSize};
+        }
+        // A string of the state of every page: '.' if it was dropped.
+        [[nodiscard]] auto resident() const -> string {
+            string result;
+            for (size_t ii = 0; ii < pages; ii++) {
+                result += base[ii * pageSize] == 'x' ? 'x' : '.';
+            }
+            return result;
+        }
+        [[nodiscard]] auto windowSize(size_t count) const noexcept -> size_t {
+            return count * pageSize;
+        }
+
+    private:
+        size_t pageSize;
+        size_t pages;
+        char*  base = nullptr;
+    };
+
+    // Entries of one page each, in position order.
+    auto onePageEach(TestMapping const& mapping, size_t count)
+            -> vector<string_view> {
+        vector<string_view> items;
+        for (size_t ii = 0; ii < count; ii++) {
+            items.push_back(mapping.pagesAt(ii, 1));
+        }
+        return items;
+    }
+}    // namespace
+
+void testReadWindow() {
+    {
+        TestMapping const mapping(8);
+        if (!mapping.valid()) {
+            check(false, "read window test mapping");
+            return;
+        }
+        // Pages are dropped in batches of a quarter of the window.
+        ReadWindow window(
+                mapping.view(), -1, mapping.windowSize(16),
+                onePageEach(mapping, 8));
+        window.claim(0);
+        window.finish(0);
+        window.claim(1);
+        window.finish(1);
+        check(mapping.resident() == "xxxxxxxx",
+              "read window keeps pages until a batch is done");
+        window.claim(2);
+        window.finish(3);
+        check(mapping.resident() == "xxxxxxxx",
+              "read window keeps pages after an unfinished entry");
+        window.finish(2);
+        check(mapping.resident() == "....xxxx",
+              "read window drops a batch of finished pages");
+        for (size_t ii = 4; ii < 8; ii++) {
+            window.claim(ii);
+            window.finish(ii);
+        }
+        check(mapping.resident() == "........",
+              "read window drops everything at the end");
+    }
+    {
+        // The entry at page 6 is claimed first, as large ones would be.
+        TestMapping const   mapping(8);
+        vector<string_view> items{mapping.pagesAt(6, 1)};
+        for (size_t ii = 0; ii < 6; ii++) {
+            items.push_back(mapping.pagesAt(ii, 1));
+        }
+        items.push_back(mapping.pagesAt(7, 1));
+        ReadWindow window(mapping.view(), -1, mapping.windowSize(4), items);
+        window.claim(0);
+        window.finish(0);
+        check(mapping.resident() == "xxxxxx.x",
+              "read window drops an entry read out of order once finished");
+        window.claim(1);
+        window.finish(1);
+        check(mapping.resident() == ".xxxxx.x",
+              "read window drops pages behind the entries to be read");
+    }
+    {
+        // Entries that share pages with their neighbours.
+        TestMapping const   mapping(4);
+        string_view const   all = mapping.view();
+        size_t const        mid = all.size() / 2;
+        vector<string_view> items{
+                all.substr(mid + 10), all.substr(0, 10),
+                all.substr(10, mid)};
+        ReadWindow window(all, -1, mapping.windowSize(4), items);
+        window.claim(0);
+        window.finish(0);
+        check(mapping.resident() == "xxx.",
+              "read window keeps pages shared with other entries");
+    }
+    {
+        TestMapping const mapping(4);
+        ReadWindow        window(
+                mapping.view(), -1, 0, onePageEach(mapping, 4));
+        for (size_t ii = 0; ii < 4; ii++) {
+            window.claim(ii);
+            window.finish(ii);
+        }
+        check(mapping.resident() == "xxxx",
+              "read window of size zero drops nothing");
+    }
+}
@@ -0,0 +1,125 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "codec.hh"
+#include "jsoncut.hh"
+#include "sorceryobb.hh"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+void testJsonCut() {
+    {
+        JsonCutFinder finder;
+        check(finder.scan(R"("abc")"sv, 0) == 0,
+              "JSON without a place to cut");
+    }
+    {
+        JsonCutFinder finder;
+        check(finder.scan(R"({"a":[1,2)"sv, 0) == 8,
+              "JSON is cut after the last comma");
+    }
+    {
+        JsonCutFinder finder;
+        check(finder.scan(R"({"x":"a,b\",[c{")"sv, 0) == 1,
+              "JSON is not cut inside strings");
+    }
+    {
+        // The pieces split an escape inside a string.
+        JsonCutFinder finder;
+        check(finder.scan(R"({"k":"a\)"sv, 0) == 1
+                      && finder.scan(R"(",b",)"sv, 8) == 13
+                      && finder.scan(R"("c")"sv, 13) == 13,
+              "JSON cut is found across pieces");
+    }
+}
+
+void testReadStitch() {
+    // Stitches between filler, which the ranges never cover.
+    string const first  = R"({"a":1,"b":[2,"three"]})"s;
+    string const second = R"(["x",{"y":"z"}])"s;
+    string const filler = makeText(3U * 1024U * 1024U);
+    string const ink    = filler + first + filler + second + "\n"s;
+    auto const   range  = [](size_t offset, string const& stitch) {
+        return std::to_string(offset) + ' ' + std::to_string(stitch.size());
+    };
+    // Decoy ranges outside of indexed-content are not looked at.
+    string const mainJson
+            = R"({"ranges":{"first":"0 1"},"indexed-content":{)"s
+              R"("filename":"inkcontent","other":{"second":"0 1"},)"
+              R"("ranges":{"first":")"
+              + range(filler.size(), first) + R"(","second":")"s
+              + range(2 * filler.size() + first.size(), second)
+              + R"(","outside":")"s + range(ink.size(), first) + R"("}}})"s;
+    string const firstJson  = formatJson(first);
+    string const secondJson = formatJson(R"({"content":)"s + second + '}');
+    auto const   length     = static_cast<uint32_t>(ink.size());
+
+    StoryFiles const stored{
+            ObbEntry{"main.json"sv, mainJson,
+                     static_cast<uint32_t>(mainJson.size())},
+            ObbEntry{"inkcontent"sv, ink, length}};
+    check(readStitch(stored, "first"sv) == firstJson,
+          "stitch from stored inkcontent");
+    check(readStitch(stored, "second"sv) == secondJson,
+          "stitch that is an array is wrapped in an object");
+    check(!readStitch(stored, "third"sv), "missing stitch");
+    check(throwsRuntimeError([&]() {
+              static_cast<void>(readStitch(stored, "outside"sv));
+          }),
+          "stitch outside of inkcontent throws");
+
+    string const     packedMain = deflateInto(mainJson, 6);
+    string const     compressed = deflateInto(ink, 6);
+    StoryFiles const packed{
+            ObbEntry{"main.json"sv, packedMain,
+                     static_cast<uint32_t>(mainJson.size())},
+            ObbEntry{"inkcontent"sv, compressed, length}};
+    check(readStitch(packed, "first"sv) == firstJson
+                  && readStitch(packed, "second"sv) == secondJson,
+          "stitch from compressed files");
+    vector<InflateCheckpoint> checkpoints;
+    string                    inflated(ink.size(), '\0');
+    check(inflateIndexed(
+                  compressed, inflated.data(), inflated.size(), 1U << 20U,
+                  checkpoints)
+                          == InflateStatus::eOK
+                  && !checkpoints.empty(),
+          "inkcontent checkpoints");
+    check(readStitch(packed, "first"sv, &checkpoints) == firstJson
+                  && readStitch(packed, "second"sv, &checkpoints)
+                             == secondJson,
+          "stitch from compressed inkcontent with checkpoints");
+
+    StoryFiles const missing{
+            std::nullopt, ObbEntry{"inkcontent"sv, ink, length}};
+    check(throwsRuntimeError([&]() {
+              static_cast<void>(readStitch(missing, "first"sv));
+          }),
+          "stitch without the main json throws");
+}
@@ -0,0 +1,132 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "tarwriter.hh"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+using std::ios;
+using std::string;
+using std::string_view;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+namespace {
+    // Parses an octal header field.
+    auto readOctal(string_view field) -> uint64_t {
+        uint64_t value = 0;
+        for (char const chr : field) {
+            if (chr < '0' || chr > '7') {
+                break;
+            }
+            value = value * 8U + static_cast<uint64_t>(chr - '0');
+        }
+        return value;
+    }
+
+    auto validChecksum(string_view header) -> bool {
+        uint64_t sum = 0;
+        for (size_t ii = 0; ii < TarWriter::BlockSize; ii++) {
+            bool const inField = ii >= 148 && ii < 156;
+            sum += inField ? uint64_t{' '}
+                           : static_cast<unsigned char>(header[ii]);
+        }
+        return sum == readOctal(header.substr(148, 8));
+    }
+
+    auto field(string_view header, size_t offset, size_t size) -> string_view {
+        header = header.substr(offset, size);
+        return header.substr(0, header.find('\0'));
+    }
+}    // namespace
+
+void testTar() {
+    std::ostringstream out(ios::out | ios::binary);
+    TarWriter          tar(out, 0);
+    string const       dir      = string(120, 'd');
+    string const       longName = "dir/"s + string(150, 'x');
+    string const       contents = makeText(1000);
+    tar.addFile("short.txt"sv, "hello"sv);
+    tar.addFile(dir + "/name.txt", contents);
+    tar.addFile(longName, ""sv);
+    check(tar.finish(), "tar finishes");
+
+    string const      data = out.str();
+    string_view const view(data);
+    check(data.size() % TarWriter::BlockSize == 0, "tar block alignment");
+    // short.txt: header and one data block. The long directory: header
+    // and two data blocks. The long name: pax header, its data, header.
+    // Then two zero blocks.
+    check(data.size() == 10 * TarWriter::BlockSize, "tar size");
+    if (data.size() != 10 * TarWriter::BlockSize) {
+        return;
+    }
+    auto const block = [&](size_t index) {
+        return view.substr(
+                index * TarWriter::BlockSize, TarWriter::BlockSize);
+    };
+    check(field(block(0), 0, 100) == "short.txt"sv
+                  && readOctal(block(0).substr(124, 12)) == 5
+                  && block(0)[156] == '0'
+                  && field(block(0), 257, 6) == "ustar"sv,
+          "tar header of a short name");
+    check(block(1).substr(0, 5) == "hello"sv
+                  && block(1).find_first_not_of('\0', 5)
+                             == string_view::npos,
+          "tar data is zero-padded");
+    check(field(block(2), 0, 100) == "name.txt"sv
+                  && field(block(2), 345, 155) == dir
+                  && readOctal(block(2).substr(124, 12)) == contents.size(),
+          "tar name split into prefix");
+    check(view.substr(3 * TarWriter::BlockSize, contents.size())
+                  == contents,
+          "tar file data");
+    // The record length has three digits.
+    string const paxRecord = " path="s + longName + '\n';
+    string const paxData
+            = std::to_string(paxRecord.size() + 3) + paxRecord;
+    check(block(5)[156] == 'x'
+                  && readOctal(block(5).substr(124, 12)) == paxData.size()
+                  && block(6).substr(0, paxData.size()) == paxData,
+          "pax header for a long name");
+    check(block(7)[156] == '0'
+                  && field(block(7), 0, 100) == longName.substr(0, 100),
+          "tar header after a pax header");
+    for (size_t const index : {0U, 2U, 5U, 7U}) {
+        check(validChecksum(block(index)),
+              "tar checksum of block " + std::to_string(index));
+    }
+    check(view.substr(8 * TarWriter::BlockSize).find_first_not_of('\0')
+                  == string_view::npos,
+          "tar end-of-archive marker");
+
+    // Once the stream fails, nothing more is written, and finish says so.
+    std::ostringstream failing(ios::out | ios::binary);
+    TarWriter          broken(failing, 0);
+    broken.addFile("first.txt"sv, "data"sv);
+    size_t const written = failing.str().size();
+    failing.setstate(ios::badbit);
+    broken.addFile("second.txt"sv, "data"sv);
+    check(!broken.finish() && failing.str().size() == written,
+          "tar stops writing after an error");
+}
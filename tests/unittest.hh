@@ -0,0 +1,110 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Shared by the unit tests of each module, which "make test" runs.
+
+// Counts a check, and prints it if it failed.
+void check(bool condition, std::string_view what);
+
+template <typename Callable>
+[[nodiscard]] auto throwsRuntimeError(Callable callable) -> bool {
+    try {
+        callable();
+    } catch (std::runtime_error const&) {
+        return true;
+    }
+    return false;
+}
+
+// Text with enough variety that deflate emits several blocks for it.
+[[nodiscard]] auto makeText(size_t length) -> std::string;
+
+void writeFile(boost::filesystem::path const& fname, std::string_view data);
+
+// An entry of a test OBB; its data is compressed if its size differs from
+// fulllength.
+struct TestEntry {
+    std::string name;
+    std::string data;
+    uint32_t    fulllength;
+};
+
+// Writes an OBB holding the entries, which must be sorted by name.
+void writeObb(
+        boost::filesystem::path const& fname,
+        std::vector<TestEntry> const& entries);
+
+// Runs a program with the given arguments, its output discarded, and returns
+// its exit status, or -1 if it did not exit normally.
+[[nodiscard]] auto runProgram(
+        boost::filesystem::path const&  program,
+        std::vector<std::string> const& arguments) -> int;
+
+// Limits the size of the files the process can write while it lives, so that
+// writes past the limit fail (with EFBIG) rather than the disk filling up.
+class FileSizeLimit {
+public:
+    explicit FileSizeLimit(uint64_t limit);
+    FileSizeLimit(FileSizeLimit const&) = delete;
+    FileSizeLimit(FileSizeLimit&&)      = delete;
+    auto operator=(FileSizeLimit const&) -> FileSizeLimit& = delete;
+    auto operator=(FileSizeLimit&&) -> FileSizeLimit& = delete;
+    ~FileSizeLimit() noexcept;
+
+private:
+    uint64_t current;
+    uint64_t maximum;
+};
+
+// The tests of each module. Those given a directory may create files in it.
+void testHash();
+void testGlobs();
+void testTar();
+void testInflate();
+void testCodecBackends();
+void testOutputMapping(boost::filesystem::path const& tmpdir);
+void testUringWriter(boost::filesystem::path const& tmpdir);
+void testFileIndex();
+void testManifest(boost::filesystem::path const& tmpdir);
+void testCloneFile(boost::filesystem::path const& tmpdir);
+void testListing(boost::filesystem::path const& tmpdir);
+void testSameContents();
+void testCompareTables(boost::filesystem::path const& tmpdir);
+void testReadWindow();
+void testJsonPipeline();
+void testMemoryBudget();
+void testEventLog(boost::filesystem::path const& tmpdir);
+void testJsonCut();
+void testReadStitch();
+void testInflateIndexed();
+void testInflateIndex(boost::filesystem::path const& tmpdir);
+void testVerify(
+        boost::filesystem::path const& tmpdir,
+        boost::filesystem::path const& xtractobb);
+void testDedup(
+        boost::filesystem::path const& tmpdir,
+        boost::filesystem::path const& xtractobb);
@@ -0,0 +1,200 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Round-trip and known-answer tests for the modules shared by the tools; run
+// by "make test". Prints each failed check, and exits with an error if there
+// were any.
+
+#include "unittest.hh"
+
+#include "endianio.hh"
+#include "obbarchive.hh"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+using std::cerr;
+using std::endl;
+using std::ios;
+using std::string;
+using std::string_view;
+using std::vector;
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+using boost::filesystem::ofstream;
+using boost::filesystem::path;
+
+namespace {
+    size_t numChecks   = 0;
+    size_t numFailures = 0;
+
+    // Runs a test, counting an exception that escapes it as a failure.
+    template <typename Test>
+    void run(string_view name, Test test) {
+        try {
+            test();
+        } catch (std::exception const& except) {
+            numFailures++;
+            cerr << "FAILED: " << name << " threw: " << except.what() << endl;
+        }
+    }
+}    // namespace
+
+void check(bool condition, string_view what) {
+    numChecks++;
+    if (!condition) {
+        numFailures++;
+        cerr << "FAILED: " << what << endl;
+    }
+}
+
+auto makeText(size_t length) -> string {
+    string   text;
+    uint32_t state = 12345U;
+    while (text.size() < length) {
+        state = state * 1103515245U + 12345U;
+        text += "line "s + std::to_string(text.size()) + ": "s
+                + std::to_string(state >> 8U) + '\n';
+    }
+    text.resize(length);
+    return text;
+}
+
+void writeFile(path const& fname, string_view data) {
+    ofstream fout(fname, ios::out | ios::binary | ios::trunc);
+    fout.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+void writeObb(path const& fname, vector<TestEntry> const& entries) {
+    string           body;
+    vector<uint32_t> dataOffsets;
+    vector<uint32_t> nameOffsets;
+    for (auto const& entry : entries) {
+        dataOffsets.push_back(static_cast<uint32_t>(
+                ObbArchive::HeaderSize + body.size()));
+        body += entry.data;
+    }
+    for (auto const& entry : entries) {
+        nameOffsets.push_back(static_cast<uint32_t>(
+                ObbArchive::HeaderSize + body.size()));
+        body += entry.name;
+    }
+    size_t const tableOffset = ObbArchive::HeaderSize + body.size();
+    size_t const obbSize = tableOffset + entries.size() * ObbArchive::EntrySize;
+    std::ostringstream obb(ios::out | ios::binary);
+    obb << "AP_Pack!"sv;
+    Write4(obb, static_cast<uint32_t>(obbSize));
+    Write4(obb, static_cast<uint32_t>(tableOffset));
+    obb << body;
+    for (size_t ii = 0; ii < entries.size(); ii++) {
+        Write4(obb, nameOffsets[ii]);
+        Write4(obb, static_cast<uint32_t>(entries[ii].name.size()));
+        Write4(obb, dataOffsets[ii]);
+        Write4(obb, static_cast<uint32_t>(entries[ii].data.size()));
+        Write4(obb, entries[ii].fulllength);
+    }
+    writeFile(fname, obb.str());
+}
+
+auto runProgram(path const& program, vector<string> const& arguments) -> int {
+    // Quotes each argument for the shell.
+    auto const quote = [](string const& argument) {
+        string quoted = "'"s;
+        for (char const chr : argument) {
+            quoted += chr == '\'' ? "'\\''"s : string(1, chr);
+        }
+        return quoted + "'"s;
+    };
+    string command = quote(program.string());
+    for (auto const& argument : arguments) {
+        command += ' ' + quote(argument);
+    }
+    command += " >/dev/null 2>&1"s;
+    int const status = std::system(command.c_str());
+    return status != -1 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+FileSizeLimit::FileSizeLimit(uint64_t limit) {
+    rlimit value{};
+    ::getrlimit(RLIMIT_FSIZE, &value);
+    current        = value.rlim_cur;
+    maximum        = value.rlim_max;
+    value.rlim_cur = limit;
+    ::setrlimit(RLIMIT_FSIZE, &value);
+}
+
+FileSizeLimit::~FileSizeLimit() noexcept {
+    rlimit const value{current, maximum};
+    ::setrlimit(RLIMIT_FSIZE, &value);
+}
+
+auto main(int argc, char* argv[]) -> int {
+    if (argc > 2) {
+        cerr << "Usage: " << argv[0] << " [xtractobb]" << endl;
+        return EXIT_FAILURE;
+    }
+    // Going past a FileSizeLimit would otherwise end the process.
+    std::signal(SIGXFSZ, SIG_IGN);
+    path const tmpdir
+            = boost::filesystem::temp_directory_path()
+              / boost::filesystem::unique_path("sorceryobb-%%%%-%%%%");
+    boost::filesystem::create_directories(tmpdir);
+    run("hash"sv, testHash);
+    run("globs"sv, testGlobs);
+    run("tar"sv, testTar);
+    run("inflate"sv, testInflate);
+    run("codec backends"sv, testCodecBackends);
+    run("output mapping"sv, [&]() { testOutputMapping(tmpdir); });
+    run("io_uring"sv, [&]() { testUringWriter(tmpdir); });
+    run("file index"sv, testFileIndex);
+    run("manifest"sv, [&]() { testManifest(tmpdir); });
+    run("clone"sv, [&]() { testCloneFile(tmpdir); });
+    run("listing"sv, [&]() { testListing(tmpdir); });
+    run("same contents"sv, testSameContents);
+    run("diff"sv, [&]() { testCompareTables(tmpdir); });
+    run("read window"sv, testReadWindow);
+    run("JSON pipeline"sv, testJsonPipeline);
+    run("memory budget"sv, testMemoryBudget);
+    run("event log"sv, [&]() { testEventLog(tmpdir); });
+    run("JSON cut"sv, testJsonCut);
+    run("stitch"sv, testReadStitch);
+    run("indexed inflate"sv, testInflateIndexed);
+    run("inflate index"sv, [&]() { testInflateIndex(tmpdir); });
+    // The tests of the programs need to know where they are.
+    if (argc == 2) {
+        path const xtractobb = boost::filesystem::absolute(argv[1]);
+        run("verify"sv, [&]() { testVerify(tmpdir, xtractobb); });
+        run("dedup"sv, [&]() { testDedup(tmpdir, xtractobb); });
+    } else {
+        cerr << "Skipped the tests of xtractobb, as its path was not given."
+             << endl;
+    }
+    boost::filesystem::remove_all(tmpdir);
+    std::cout << numChecks - numFailures << " of " << numChecks
+              << " checks passed" << endl;
+    return numFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,91 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "fileio.hh"
+#include "uringwriter.hh"
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+using boost::filesystem::path;
+
+using namespace std::literals::string_literals;
+
+void testUringWriter(path const& tmpdir) {
+    auto writer = UringWriter::create();
+    if (!writer) {
+        std::cerr << "Skipped the io_uring tests, as io_uring is unavailable."
+                  << std::endl;
+        return;
+    }
+    OutputTree const    tree(tmpdir);
+    string const        text = makeText(300000);
+    vector<string_view> written;
+    writer->onWritten([&](string_view name) { written.push_back(name); });
+
+    writer->write(tree.createFile("whole.txt", false), text, "whole.txt");
+    writer->write(
+            tree.createFile("copied.txt", false),
+            vector<char>(text.cbegin(), text.cend()), "copied.txt");
+    check(writer->finish().empty() && written.size() == 2,
+          "io_uring writes are reported written");
+
+    // The file size limit cuts the write short; the rest of the file is
+    // resubmitted once the limit is lifted, and must go after what was
+    // already written.
+    constexpr size_t const Limit = 65536;
+    {
+        FileSizeLimit const limit(Limit);
+        writer->write(tree.createFile("short.txt", false), text, "short.txt");
+        for (int ii = 0; ii < 1000 && file_size(tmpdir / "short.txt") < Limit;
+             ii++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    check(writer->finish().empty() && written.size() == 3,
+          "io_uring short write is completed");
+
+    // Buffers larger than the limit go one at a time.
+    writer->limitBuffers(text.size() / 2);
+    for (auto const* name : {"limited1.txt", "limited2.txt", "limited3.txt"}) {
+        writer->write(
+                tree.createFile(name, false),
+                vector<char>(text.cbegin(), text.cend()), name);
+    }
+    check(writer->finish().empty() && written.size() == 6,
+          "io_uring writes of limited buffers are reported written");
+
+    for (auto const* name :
+         {"whole.txt", "copied.txt", "short.txt", "limited1.txt",
+          "limited2.txt", "limited3.txt"}) {
+        InputMapping const input(tree, name);
+        check(input.valid() && input.view() == string_view(text),
+              "io_uring write of "s + name);
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "unittest.hh"
+
+#include "codec.hh"
+
+#include <boost/filesystem.hpp>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+using boost::filesystem::path;
+
+using namespace std::literals::string_literals;
+
+namespace {
+    auto verify(path const& xtractobb, path const& obb) -> int {
+        return runProgram(xtractobb, {"--verify"s, obb.string()});
+    }
+}    // namespace
+
+void testVerify(path const& tmpdir, path const& xtractobb) {
+    path const   dir        = tmpdir / "verify";
+    string const text       = makeText(50000);
+    string const compressed = deflateInto(text, 9);
+    auto const   fulllength = static_cast<uint32_t>(text.size());
+    create_directories(dir);
+
+    writeObb(dir / "good.obb",
+             {{"stored.txt"s, "stored contents"s, 15U},
+              {"compressed.txt"s, compressed, fulllength}});
+    check(verify(xtractobb, dir / "good.obb") == 0, "valid OBB verifies");
+    check(std::distance(
+                  boost::filesystem::directory_iterator(dir),
+                  boost::filesystem::directory_iterator())
+                  == 1,
+          "verifying writes no files");
+
+    writeObb(dir / "length.obb",
+             {{"compressed.txt"s, compressed, fulllength + 1}});
+    check(verify(xtractobb, dir / "length.obb") == 6,
+          "wrong decompressed length fails verification");
+
+    string corrupt = compressed;
+    corrupt.back() ^= '\x55';
+    writeObb(dir / "corrupt.obb",
+             {{"stored.txt"s, "stored contents"s, 15U},
+              {"compressed.txt"s, corrupt, fulllength}});
+    check(verify(xtractobb, dir / "corrupt.obb") == 6,
+          "invalid compressed data fails verification");
+
+    writeFile(dir / "header.obb", "AP_Pack?"s + string(16, '\0'));
+    check(verify(xtractobb, dir / "header.obb") != 0,
+          "wrong signature fails verification");
+
+    // Makes the data of the only entry run past the end of the file, by
+    // patching its stored and full lengths, the last fields of the table.
+    writeObb(dir / "range.obb", {{"stored.txt"s, "stored contents"s, 15U}});
+    {
+        boost::filesystem::fstream obb(
+                dir / "range.obb",
+                std::ios::in | std::ios::out | std::ios::binary);
+        obb.seekp(-8, std::ios::end);
+        obb.write("\0\x10\0\0\0\x10\0\0", 8);
+    }
+    check(verify(xtractobb, dir / "range.obb") == 6,
+          "entry outside the file fails verification");
+}
@@ -0,0 +1,426 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "uringwriter.hh"
+
+#ifdef XTRACTOBB_IO_URING
+#    include <linux/io_uring.h>
+#    include <sys/mman.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+
+#    include <algorithm>
+#    include <array>
+#    include <cerrno>
+#    include <cstdint>
+#    include <cstring>
+#    include <stdexcept>
+#    include <utility>
+#endif
+
+using std::lock_guard;
+using std::mutex;
+using std::string_view;
+using std::unique_ptr;
+using std::vector;
+
+#ifdef XTRACTOBB_IO_URING
+
+namespace {
+    // Each file takes a write and a close.
+    constexpr unsigned const RingEntries = 4 * UringWriter::QueueDepth;
+
+    // Requests in a chain, kept in the low bit of the user data.
+    enum Operation : uint64_t { eWRITE, eCLOSE };
+
+    template <typename T>
+    auto ringPointer(void* base, uint32_t offset) noexcept -> T* {
+        return static_cast<T*>(static_cast<void*>(
+                static_cast<char*>(base) + offset));
+    }
+
+    auto enter(int fd, unsigned toSubmit, unsigned minComplete) noexcept
+            -> int {
+        unsigned const flags = minComplete != 0 ? IORING_ENTER_GETEVENTS : 0U;
+        int            result = 0;
+        do {
+            result = static_cast<int>(syscall(
+                    __NR_io_uring_enter, fd, toSubmit, minComplete, flags,
+                    nullptr, 0));
+        } while (result < 0 && errno == EINTR);
+        return result;
+    }
+
+    // IORING_OP_WRITE and IORING_OP_CLOSE were added in Linux 5.6, along with
+    // the probe; older kernels fail the probe, and would fail every request.
+    auto supportsRequests(int fd) noexcept -> bool {
+        constexpr unsigned const NumOps
+                = std::max<unsigned>(IORING_OP_WRITE, IORING_OP_CLOSE) + 1;
+        alignas(io_uring_probe) std::array<
+                char, sizeof(io_uring_probe) + NumOps * sizeof(io_uring_probe_op)>
+                buffer{};
+        auto* probe = ringPointer<io_uring_probe>(buffer.data(), 0);
+        if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe,
+                    NumOps)
+            < 0) {
+            return false;
+        }
+        auto const supported = [probe](unsigned op) noexcept {
+            return op < probe->ops_len
+                   && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+        };
+        return supported(IORING_OP_WRITE) && supported(IORING_OP_CLOSE);
+    }
+}    // namespace
+
+struct UringWriter::Ring {
+    struct Slot {
+        vector<char> buffer;
+        string_view  contents;
+        string_view  name;
+        // Where in the file the rest of contents goes.
+        uint64_t     written = 0;
+        int          fd      = -1;
+        unsigned     pending = 0;
+        bool         failed  = false;
+        // The close was cancelled, so the descriptor is still open.
+        bool         open    = false;
+    };
+
+    int           fd        = -1;
+    void*         sqMap     = MAP_FAILED;
+    size_t        sqMapSize = 0;
+    void*         cqMap     = MAP_FAILED;
+    size_t        cqMapSize = 0;
+    io_uring_sqe* sqes      = nullptr;
+    size_t        sqesSize  = 0;
+
+    unsigned*     sqTail  = nullptr;
+    unsigned*     sqMask  = nullptr;
+    unsigned*     sqArray = nullptr;
+    unsigned*     cqHead  = nullptr;
+    unsigned*     cqTail  = nullptr;
+    unsigned*     cqMask  = nullptr;
+    io_uring_cqe* cqes    = nullptr;
+
+    std::array<Slot, QueueDepth>     slots;
+    vector<unsigned>                 freeSlots;
+    vector<string_view>              failures;
+    std::function<void(string_view)> written;
+    unsigned                         inFlight = 0;
+    // Bytes of the buffers of the files in flight, and how many there may be.
+    size_t buffered    = 0;
+    size_t bufferLimit = SIZE_MAX;
+    // Our copy of the submission tail, and how many entries behind it the
+    // kernel has not consumed yet.
+    unsigned localTail = 0;
+    unsigned toSubmit  = 0;
+
+    Ring() = default;
+    Ring(Ring const&) = delete;
+    Ring(Ring&&)      = delete;
+    auto operator=(Ring const&) -> Ring& = delete;
+    auto operator=(Ring&&) -> Ring& = delete;
+    ~Ring() noexcept {
+        if (sqes != nullptr) {
+            munmap(sqes, sqesSize);
+        }
+        if (cqMap != MAP_FAILED && cqMap != sqMap) {
+            munmap(cqMap, cqMapSize);
+        }
+        if (sqMap != MAP_FAILED) {
+            munmap(sqMap, sqMapSize);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    [[nodiscard]] auto setup() noexcept -> bool;
+    auto nextSqe() noexcept -> io_uring_sqe*;
+    void submit();
+    void release(unsigned index);
+    void reap();
+    void wait();
+    [[nodiscard]] auto acquireSlot() -> unsigned;
+    void queue(unsigned index);
+};
+
+auto UringWriter::Ring::setup() noexcept -> bool {
+    io_uring_params params{};
+    fd = static_cast<int>(syscall(__NR_io_uring_setup, RingEntries, &params));
+    if (fd < 0 || !supportsRequests(fd)) {
+        return false;
+    }
+    sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool const singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) {
+        sqMapSize = cqMapSize = std::max(sqMapSize, cqMapSize);
+    }
+    sqMap = mmap(
+            nullptr, sqMapSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqMap == MAP_FAILED) {
+        return false;
+    }
+    cqMap = singleMap ? sqMap
+                      : mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, fd,
+                             IORING_OFF_CQ_RING);
+    if (cqMap == MAP_FAILED) {
+        return false;
+    }
+    sqesSize      = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqesMap = mmap(
+            nullptr, sqesSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqesMap == MAP_FAILED) {
+        return false;
+    }
+    sqes      = static_cast<io_uring_sqe*>(sqesMap);
+    sqTail    = ringPointer<unsigned>(sqMap, params.sq_off.tail);
+    localTail = *sqTail;
+    sqMask    = ringPointer<unsigned>(sqMap, params.sq_off.ring_mask);
+    sqArray   = ringPointer<unsigned>(sqMap, params.sq_off.array);
+    cqHead    = ringPointer<unsigned>(cqMap, params.cq_off.head);
+    cqTail    = ringPointer<unsigned>(cqMap, params.cq_off.tail);
+    cqMask    = ringPointer<unsigned>(cqMap, params.cq_off.ring_mask);
+    cqes      = ringPointer<io_uring_cqe>(cqMap, params.cq_off.cqes);
+
+    freeSlots.reserve(QueueDepth);
+    for (unsigned ii = QueueDepth; ii > 0; ii--) {
+        freeSlots.push_back(ii - 1);
+    }
+    return true;
+}
+
+auto UringWriter::Ring::nextSqe() noexcept -> io_uring_sqe* {
+    unsigned const index = localTail++ & *sqMask;
+    sqArray[index]       = index;
+    toSubmit++;
+    io_uring_sqe* sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+void UringWriter::Ring::submit() {
+    __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+    while (toSubmit != 0) {
+        int const result = enter(fd, toSubmit, 0);
+        if (result < 0) {
+            if (errno != EAGAIN && errno != EBUSY) {
+                throw std::runtime_error("Could not submit to io_uring!");
+            }
+            // Out of resources until some requests complete.
+            enter(fd, 0, 1);
+            reap();
+            continue;
+        }
+        toSubmit -= static_cast<unsigned>(result);
+    }
+}
+
+void UringWriter::Ring::release(unsigned index) {
+    Slot& slot = slots[index];
+    if (slot.failed) {
+        failures.push_back(slot.name);
+    } else if (written) {
+        written(slot.name);
+    }
+    buffered -= slot.buffer.size();
+    slot.buffer  = vector<char>();
+    slot.written = 0;
+    slot.fd      = -1;
+    slot.failed  = false;
+    slot.open    = false;
+    freeSlots.push_back(index);
+}
+
+void UringWriter::Ring::reap() {
+    unsigned         head = *cqHead;
+    unsigned const   tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+    vector<unsigned> unfinished;
+    for (; head != tail; head++) {
+        io_uring_cqe const& cqe   = cqes[head & *cqMask];
+        auto const          index = static_cast<unsigned>(cqe.user_data >> 1U);
+        int const           result = cqe.res;
+        Slot&               slot   = slots[index];
+        if ((cqe.user_data & 1U) == eWRITE) {
+            // Nothing written at all would never get anywhere.
+            slot.failed = result < 0 || (result == 0 && !slot.contents.empty());
+            if (!slot.failed) {
+                slot.contents.remove_prefix(static_cast<size_t>(result));
+                slot.written += static_cast<uint64_t>(result);
+            }
+        } else if (result == -ECANCELED) {
+            // A failed or short write breaks the chain.
+            slot.open = true;
+        } else if (result < 0) {
+            slot.failed = true;
+        }
+        if (--slot.pending != 0) {
+            continue;
+        }
+        inFlight--;
+        if (slot.open && !slot.failed && !slot.contents.empty()) {
+            // The rest of a short write is written again.
+            unfinished.push_back(index);
+            continue;
+        }
+        if (slot.open) {
+            close(slot.fd);
+        }
+        release(index);
+    }
+    __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    // Queueing may reap again, so this waits until the queue is consistent.
+    for (unsigned const index : unfinished) {
+        queue(index);
+    }
+}
+
+void UringWriter::Ring::wait() {
+    if (enter(fd, 0, 1) < 0 && errno != EAGAIN && errno != EBUSY) {
+        throw std::runtime_error("Could not wait for io_uring!");
+    }
+    reap();
+}
+
+auto UringWriter::Ring::acquireSlot() -> unsigned {
+    reap();
+    while (freeSlots.empty()) {
+        wait();
+    }
+    unsigned const index = freeSlots.back();
+    freeSlots.pop_back();
+    return index;
+}
+
+void UringWriter::Ring::queue(unsigned index) {
+    Slot& slot   = slots[index];
+    slot.pending = 2;
+    slot.open    = false;
+    inFlight++;
+
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode       = IORING_OP_WRITE;
+    sqe->flags        = IOSQE_IO_LINK;
+    sqe->fd           = slot.fd;
+    sqe->addr         = reinterpret_cast<uintptr_t>(slot.contents.data());
+    sqe->len          = static_cast<uint32_t>(slot.contents.size());
+    sqe->off          = slot.written;
+    sqe->user_data    = (uint64_t{index} << 1U) | eWRITE;
+
+    sqe            = nextSqe();
+    sqe->opcode    = IORING_OP_CLOSE;
+    sqe->fd        = slot.fd;
+    sqe->user_data = (uint64_t{index} << 1U) | eCLOSE;
+
+    submit();
+}
+
+auto UringWriter::create() -> unique_ptr<UringWriter> {
+    auto ring = std::make_unique<Ring>();
+    if (!ring->setup()) {
+        return nullptr;
+    }
+    return unique_ptr<UringWriter>(new UringWriter(std::move(ring)));
+}
+
+UringWriter::~UringWriter() noexcept {
+    try {
+        static_cast<void>(finish());
+    } catch (...) {
+    }
+}
+
+void UringWriter::write(
+        UniqueFd file, string_view contents, string_view name) {
+    lock_guard<mutex> lock(ring_mutex);
+    unsigned const    index = ring->acquireSlot();
+    Ring::Slot&       slot  = ring->slots[index];
+    slot.contents           = contents;
+    slot.name               = name;
+    slot.fd                 = file.release();
+    ring->queue(index);
+}
+
+void UringWriter::write(
+        UniqueFd file, vector<char>&& contents, string_view name) {
+    vector<char> buffer(std::move(contents));
+    string_view  view(buffer.data(), buffer.size());
+    lock_guard<mutex> lock(ring_mutex);
+    // Only other buffers can hold this one up, so it always gets in.
+    while (ring->buffered != 0
+           && ring->buffered + buffer.size() > ring->bufferLimit) {
+        ring->wait();
+    }
+    ring->buffered += buffer.size();
+
+    unsigned const index = ring->acquireSlot();
+    Ring::Slot&    slot  = ring->slots[index];
+    slot.buffer          = std::move(buffer);
+    slot.contents        = view;
+    slot.name            = name;
+    slot.fd              = file.release();
+    ring->queue(index);
+}
+
+void UringWriter::limitBuffers(size_t limit) {
+    lock_guard<mutex> lock(ring_mutex);
+    ring->bufferLimit = limit;
+}
+
+void UringWriter::onWritten(std::function<void(string_view)> handler) {
+    lock_guard<mutex> lock(ring_mutex);
+    ring->written = std::move(handler);
+}
+
+auto UringWriter::finish() -> vector<string_view> {
+    lock_guard<mutex> lock(ring_mutex);
+    while (ring->inFlight != 0) {
+        ring->wait();
+    }
+    return std::exchange(ring->failures, {});
+}
+
+#else
+
+struct UringWriter::Ring {};
+
+auto UringWriter::create() -> unique_ptr<UringWriter> {
+    return nullptr;
+}
+
+UringWriter::~UringWriter() noexcept = default;
+
+void UringWriter::write(UniqueFd, string_view, string_view) {}
+
+void UringWriter::write(UniqueFd, vector<char>&&, string_view) {}
+
+void UringWriter::limitBuffers(size_t) {}
+
+void UringWriter::onWritten(std::function<void(string_view)>) {}
+
+auto UringWriter::finish() -> vector<string_view> {
+    return {};
+}
+
+#endif
+
+UringWriter::UringWriter(unique_ptr<Ring> _ring) noexcept
+        : ring(std::move(_ring)) {}
@@ -0,0 +1,85 @@
+/*
+ *	Copyright © 2026 Flamewing <flamewing.sonic@gmail.com>
+ *
+ *	This program is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	This program is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "fileio.hh"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#    define XTRACTOBB_IO_URING 1
+#endif
+
+// Writes whole files through io_uring. The caller opens each file, and its
+// write and close are submitted as a chain of linked requests, so the caller
+// can go on decoding the next file while the kernel works. Many files are kept
+// in flight at once. Files which are only partly written are resubmitted from
+// where the write stopped.
+//
+// It is shared by all extraction workers. create() returns nothing if the
+// kernel has no io_uring, or if its io_uring cannot write and close files
+// (before Linux 5.6); callers then fall back to writing files themselves.
+class UringWriter {
+public:
+    // Number of files that can be in flight at once.
+    static constexpr unsigned const QueueDepth = 64;
+    // Larger files are better served by mapping the output file.
+    static constexpr size_t const MaxFileSize = 1ULL << 20U;
+
+    [[nodiscard]] static auto create() -> std::unique_ptr<UringWriter>;
+
+    UringWriter(UringWriter const&) = delete;
+    UringWriter(UringWriter&&)      = delete;
+    auto operator=(UringWriter const&) -> UringWriter& = delete;
+    auto operator=(UringWriter&&) -> UringWriter& = delete;
+    // Waits for any files still in flight.
+    ~UringWriter() noexcept;
+
+    // Queues contents to be written to file, which must be valid and open
+    // for writing, waiting while the queue is full. The file is closed once
+    // written. In the first form, contents must remain valid until finish().
+    // name identifies the file in the result of finish().
+    void write(
+            UniqueFd file, std::string_view contents, std::string_view name);
+    void write(
+            UniqueFd file, std::vector<char>&& contents,
+            std::string_view name);
+    // Makes the second form wait while the buffers in flight and contents
+    // together would take more than limit bytes, unless no buffers are in
+    // flight. There is no limit by default.
+    void limitBuffers(size_t limit);
+    // Sets a function to be called with the name of each file once it has
+    // been written and closed; it is called by whichever thread notices,
+    // while the queue is locked. Must be set before queueing any files.
+    void onWritten(std::function<void(std::string_view)> handler);
+    // Waits until all queued files are done, and returns the names of those
+    // which could not be written; the caller should remove such files.
+    [[nodiscard]] auto finish() -> std::vector<std::string_view>;
+
+private:
+    struct Ring;
+
+    explicit UringWriter(std::unique_ptr<Ring> _ring) noexcept;
+
+    std::unique_ptr<Ring> ring;
+    std::mutex            ring_mutex;
+};
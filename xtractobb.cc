@@ -15,14 +15,33 @@
  *	along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "fileentry.hh"
+#include "codec.hh"
+#include "console.hh"
+#include "eventlog.hh"
+#include "fileindex.hh"
+#include "fileio.hh"
+#include "hash.hh"
+#include "inflateindex.hh"
+#include "jsonpipeline.hh"
+#include "jsonstitch.hh"
 #include "jsont.hh"
+#include "listing.hh"
+#include "manifest.hh"
+#include "memorybudget.hh"
+#include "namefilter.hh"
+#include "obbdiff.hh"
+#include "obbarchive.hh"
 #include "prettyJson.hh"
+#include "readwindow.hh"
+#include "sorceryobb.hh"
+#include "stats.hh"
+#include "tarwriter.hh"
+#include "uringwriter.hh"
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
-#include <boost/interprocess/streams/bufferstream.hpp>
 #include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/device/file.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
@@ -30,166 +49,66 @@
 #include <boost/iostreams/filter/zlib.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/stream.hpp>
-#include <boost/serialization/vector.hpp>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <exception>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <memory>
-#include <regex>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <set>
+#include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#ifdef _WIN32
+#    include <fcntl.h>
+#    include <io.h>
+#endif
+
 using std::allocator;
+using std::atomic;
 using std::cerr;
 using std::cout;
 using std::endl;
 using std::exception;
-using std::flush;
+using std::exception_ptr;
 using std::ios;
 using std::istream;
+using std::lock_guard;
+using std::mutex;
+using std::optional;
 using std::ostream;
-using std::regex;
-using std::regex_match;
 using std::string;
 using std::string_view;
+using std::thread;
 using std::vector;
 
 using namespace std::literals::string_literals;
 using namespace std::literals::string_view_literals;
 
-using boost::archive::text_oarchive;
 using boost::filesystem::ifstream;
 using boost::filesystem::ofstream;
 using boost::filesystem::path;
 using boost::iostreams::aggregate_filter;
 using boost::iostreams::filtering_ostream;
-using boost::iostreams::mapped_file_source;
 using boost::iostreams::zlib_decompressor;
 namespace zlib = boost::iostreams::zlib;
 
-using ibufferstream = boost::interprocess::basic_ibufferstream<char>;
-
-// Sorcery! JSON stitch filter for boost::filtering_ostream
-template <typename Ch, typename Alloc = allocator<Ch>>
-class basic_json_stitch_filter : public aggregate_filter<Ch, Alloc> {
-private:
-    using base_type   = aggregate_filter<Ch, Alloc>;
-    using vector_type = typename base_type::vector_type;
-
-public:
-    using char_type = typename base_type::char_type;
-    using category  = typename base_type::category;
-
-    // TODO: Filter should receive output directory instead.
-    explicit basic_json_stitch_filter(string_view const _inkContent)
-            : inkContent(_inkContent) {}
-
-private:
-    auto printValueRaw(vectorstream& sint, jsont::Tokenizer& reader)
-            -> decltype(auto) {
-        return sint << reader.dataValue();
-    }
-
-    auto printValueObject(vectorstream& sint, jsont::Tokenizer& reader)
-            -> decltype(auto) {
-        return sint << reader.dataValue() << ':';
-    }
-
-    void handleObjectOrStitch(vectorstream& sint, jsont::Tokenizer& reader) {
-        if (reader.dataValue() != R"("indexed-content")"sv) {
-            printValueObject(sint, reader);
-            return;
-        }
-        sint << R"("stitches":)"sv;
-        jsont::Token tok = reader.next();
-        assert(tok == jsont::ObjectStart);
-        printValueRaw(sint, reader);
-        tok = reader.next();
-        while (tok != jsont::ObjectEnd) {
-            assert(tok == jsont::FieldName);
-            if (reader.dataValue() == R"("filename")"sv) {
-                // TODO: instead of being discarded, this should be used with
-                // output directory to open stitch source file
-                tok = reader.next();    // Fetch filename...
-                assert(tok == jsont::String);
-                tok = reader.next();    // ... and discard it
-                assert(tok == jsont::Comma);
-                tok = reader.next();    // Discard comma after it as well
-            } else if (reader.dataValue() == R"("ranges")"sv) {
-                // The meat.
-                tok = reader.next();
-                assert(tok == jsont::ObjectStart);
-                tok = reader.next();
-                while (tok != jsont::ObjectEnd) {
-                    assert(tok == jsont::FieldName);
-                    printValueObject(sint, reader);
-                    tok = reader.next();
-                    assert(tok == jsont::String);
-                    string_view slice = reader.dataValue();
-                    // Remove starting double-quotes
-                    slice.remove_prefix(1);
-                    ibufferstream sptr(
-                            slice.data(), slice.length(),
-                            ios::in | ios::binary);
-                    unsigned offset = 0;
-                    unsigned length = 0;
-                    sptr >> offset >> length;
-                    string_view stitch(inkContent.substr(offset, length));
-
-                    if (stitch[0] == '[') {
-                        sint << R"({"content":)"sv << stitch << '}';
-                    } else {
-                        sint << stitch;
-                    }
-                    tok = reader.next();
-                    if (tok == jsont::Comma) {
-                        printValueRaw(sint, reader);
-                        tok = reader.next();
-                    }
-                }
-                assert(tok == jsont::ObjectEnd);
-                tok = reader.next();
-            }
-        }
-        assert(tok == jsont::ObjectEnd);
-        printValueRaw(sint, reader);
-    }
-
-    void do_filter(vector_type const& src, vector_type& dest) final {
-        vectorstream sint(ios::in | ios::out | ios::binary);
-        sint.reserve(src.size() * 3 / 2);
-        jsont::Tokenizer reader(src.data(), src.size());
-        jsont::Token     tok = reader.current();
-        while (true) {
-            if (tok == jsont::FieldName) {
-                handleObjectOrStitch(sint, reader);
-            } else if (tok == jsont::Error || tok == jsont::End) {
-                if (tok == jsont::Error) {
-                    cerr << reader.errorMessage() << endl;
-                }
-                sint.swap_vector(dest);
-                return;
-            } else {
-                printValueRaw(sint, reader);
-            }
-            tok = reader.next();
-        }
-        __builtin_unreachable();
-    }
-    string_view const inkContent;
-};
-// NOLINTNEXTLINE(modernize-use-trailing-return-type,readability-identifier-length)
-BOOST_IOSTREAMS_PIPABLE(basic_json_stitch_filter, 2)
-
-using json_stitch_filter  = basic_json_stitch_filter<char>;
-using wjson_stitch_filter = basic_json_stitch_filter<wchar_t>;
-
 enum ErrorCodes {
     eOK,
     eWRONG_ARGC,
@@ -199,10 +118,11 @@ enum ErrorCodes {
     eOBB_INVALID,
     eOBB_CORRUPT,
     eOUTPUT_NOT_DIR,
-    eOUTPUT_NO_ACCESS
+    eOUTPUT_NO_ACCESS,
+    eINVALID_ARGS
 };
 
-[[nodiscard]] auto readObbFile(path const& obbfile) -> mapped_file_source {
+[[nodiscard]] auto readObbFile(path const& obbfile) -> ObbArchive {
     if (!exists(obbfile)) {
         cerr << "File "sv << obbfile << " does not exist!"sv << endl << endl;
         throw ErrorCodes{eOBB_NOT_FOUND};
@@ -212,19 +132,18 @@ enum ErrorCodes {
         throw ErrorCodes{eOBB_NOT_FILE};
     }
 
-    mapped_file_source fin(obbfile);
-    if (!fin.is_open()) {
+    try {
+        return openArchive(obbfile);
+    } catch (std::ios_base::failure const&) {
         cerr << "Could not open input file "sv << obbfile << "!"sv << endl
              << endl;
         throw ErrorCodes{eOBB_NO_ACCESS};
+    } catch (bad_obb const& except) {
+        cerr << except.what() << endl << endl;
+        throw ErrorCodes{
+                except.reason() == bad_obb::eSIGNATURE ? eOBB_INVALID
+                                                       : eOBB_CORRUPT};
     }
-
-    string_view const oggview(fin.data(), fin.size());
-    if (oggview.substr(0, 8) != "AP_Pack!"sv) {
-        cerr << "Input file missing signature!"sv << endl << endl;
-        throw ErrorCodes{eOBB_INVALID};
-    }
-    return fin;
 }
 
 void createOutputDir(path const& outdir) {
@@ -245,31 +164,41 @@ void createOutputDir(path const& outdir) {
     }
 }
 
-void decodeFile(
-        zlib_decompressor& unzip, path outfile, string_view fdata,
-        string_view inkData, bool compressed, bool isReference) {
-    path const parentdir(outfile.parent_path());
-
-    if (!exists(parentdir) && !create_directories(parentdir)) {
-        cout << "\33[2K\r"sv << flush;
-        cerr << "Could not create directory "sv << parentdir << " for file "sv
-             << outfile << "!"sv << endl;
-        return;
-    }
-    if (outfile.extension() == ".minjson"s) {
-        outfile.replace_extension(".json"s);
-    }
-    ofstream fout(outfile, ios::out | ios::binary);
-    if (!fout.good()) {
-        cout << "\33[2K\r"sv << flush;
-        cerr << "Could not create file "sv << outfile << "!"sv << endl;
-        return;
+[[nodiscard]] auto outputName(string_view const fname) -> path {
+    path outname{string(fname)};
+    if (outname.extension() == ".minjson"s) {
+        outname.replace_extension(".json"s);
     }
-    if (isReference) {
-        cout << "\33[2K\rCreating reference file "sv << outfile << "... "sv
-             << flush;
+    return outname;
+}
+
+[[nodiscard]] auto isJsonFile(path const& outname) -> bool {
+    return outname.extension() == ".json"s
+           || outname.extension() == ".inkcontent"s;
+}
+
+// Classes of files, in the order they are extracted: the story files and the
+// reference built from them, which is what most tools want; the other JSON
+// files; and the assets.
+enum class Priority { eStory, eText, eAsset };
+
+[[nodiscard]] auto priorityOf(
+        StoryFiles const& story, ObbEntry const& entry, bool isReference)
+        -> Priority {
+    if (isReference || (story.mainJson && entry.name == story.mainJson->name)
+        || (story.inkContent && entry.name == story.inkContent->name)) {
+        return Priority::eStory;
     }
-    filtering_ostream fsout;
+    return isJsonFile(outputName(entry.name)) ? Priority::eText
+                                              : Priority::eAsset;
+}
+
+// Sets up fsout to turn the stored data of an entry into its extracted form;
+// the caller pushes the final sink.
+void pushDecodeFilters(
+        filtering_ostream& fsout, zlib_decompressor& unzip,
+        path const& outname, string_view inkData, bool compressed,
+        bool isReference) {
     if (compressed) {
         fsout.push(unzip);
     }
@@ -278,101 +207,1938 @@ void decodeFile(
         // inkcontent filename = indexed-content/filename
         fsout.push(json_stitch_filter(inkData));
     }
-    if (outfile.extension() == ".json"s
-        || outfile.extension() == ".inkcontent"s) {
+    if (isJsonFile(outname)) {
         fsout.push(json_filter(ePRETTY));
     }
-    fsout.push(fout);
-    fsout << fdata;
+}
+
+// Inflate index for --inflate-index, which workers add checkpoints to.
+class CheckpointCollector {
+public:
+    explicit CheckpointCollector(InflateIndex _index)
+            : index(std::move(_index)) {}
+
+    void add(
+            ObbArchive const& obb, ObbEntry const& entry,
+            vector<InflateCheckpoint> checkpoints) {
+        lock_guard<mutex> const lock(collectorMutex);
+        index.add(obb, entry, std::move(checkpoints));
+    }
+    [[nodiscard]] auto format() -> string {
+        lock_guard<mutex> const lock(collectorMutex);
+        return index.format();
+    }
+
+private:
+    mutex        collectorMutex;
+    InflateIndex index;
+};
+
+// Loads the inflate index of an earlier run, keeping the records which still
+// match obb. A missing or invalid index is the same as an empty one.
+[[nodiscard]] auto loadInflateIndex(
+        path const& indexfile, ObbArchive const& obb) -> InflateIndex {
+    boost::system::error_code error;
+    uintmax_t const           length = file_size(indexfile, error);
+    if (error) {
+        return {};
+    }
+    ifstream fin(indexfile, ios::in | ios::binary);
+    string   data(length, '\0');
+    fin.read(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!fin.good()) {
+        return {};
+    }
+    try {
+        InflateIndex index(data);
+        index.retain(obb);
+        return index;
+    } catch (std::runtime_error const&) {
+        return {};
+    }
+}
+
+// State shared by all extraction workers.
+struct ExtractContext {
+    Console&          console;
+    ObbArchive const& obb;
+    // Where files are extracted to; null when writing a tar stream.
+    OutputTree const* tree;
+    string_view       inkData;
+    // Used for kernel-side copies of stored entries; may be invalid.
+    UniqueFd const& obbfd;
+    // Manifest of the previous run, for skipping files which are already up
+    // to date and for telling which files on disk that run left behind.
+    Manifest const& previous;
+    // Extract everything, even files that are already up to date.
+    bool force;
+    // Writer for small files; null when files are written directly.
+    UringWriter* uring;
+    // Timings for --stats; null when they are not wanted.
+    StatsReport* stats;
+    // Where files are reported as they are done; null when not wanted.
+    EventLog* events;
+    // Checkpoints of large compressed entries; null when not wanted.
+    CheckpointCollector* checkpoints;
+};
+
+// Reports a file which is done to the event log, if there is one.
+void announce(
+        ExtractContext const& context, string_view const status,
+        string_view const name) {
+    if (context.events != nullptr) {
+        context.events->file(
+                status, name, context.tree->fullPath(outputName(name)));
+    }
+}
+
+// True if the entry is extracted exactly as stored.
+[[nodiscard]] auto isVerbatim(
+        ObbEntry const& entry, path const& outname, bool isReference) -> bool {
+    return !entry.compressed() && !isReference && !isJsonFile(outname);
+}
+
+// Throws bad_obb if the entry did not inflate correctly.
+void checkInflated(InflateStatus status, ObbEntry const& entry) {
+    switch (status) {
+    case InflateStatus::eOK:
+        break;
+    case InflateStatus::eSIZE_MISMATCH:
+        throw bad_obb(
+                bad_obb::eCORRUPT,
+                "Inflated size of "s + string(entry.name)
+                        + " does not match the file table!"s);
+    case InflateStatus::eDATA_ERROR:
+        throw bad_obb(
+                bad_obb::eCORRUPT,
+                "Compressed data of "s + string(entry.name) + " is corrupt!"s);
+    }
+}
+
+// Inflates an entry into output, which has room for all of it. Entries large
+// enough to have checkpoints are added to the inflate index, if there is one.
+[[nodiscard]] auto inflateEntry(
+        CheckpointCollector* checkpoints, ObbArchive const& obb,
+        ObbEntry const& entry, char* output) -> InflateStatus {
+    if (checkpoints == nullptr || entry.fulllength <= InflateIndex::Span) {
+        return inflateInto(entry.data, output, entry.fulllength);
+    }
+    vector<InflateCheckpoint> points;
+    InflateStatus const       status = inflateIndexed(
+            entry.data, output, entry.fulllength, InflateIndex::Span, points);
+    if (status == InflateStatus::eOK) {
+        checkpoints->add(obb, entry, std::move(points));
+    }
+    return status;
+}
+
+// True if compressed entries are inflated up front, into memory, rather than
+// by the decode filters. The filters always use zlib, so this lets the codec
+// backend do it instead; while an inflate index is being built, it also keeps
+// the checkpoints of large entries.
+[[nodiscard]] auto inflatesUpFront(
+        ExtractContext const& context, ObbEntry const& entry) -> bool {
+    return entry.compressed()
+           && (codecBackend() != CodecBackend::eZlib
+               || (context.checkpoints != nullptr
+                   && entry.fulllength > InflateIndex::Span));
+}
+
+// The data to decode for an entry; storage holds it when it is inflated up
+// front.
+[[nodiscard]] auto decodeInput(
+        ExtractContext const& context, ObbEntry const& entry,
+        vector<char>& storage) -> ObbEntry {
+    if (!inflatesUpFront(context, entry)) {
+        return entry;
+    }
+    storage.resize(entry.fulllength);
+    checkInflated(
+            inflateEntry(
+                    context.checkpoints, context.obb, entry, storage.data()),
+            entry);
+    return {entry.name, string_view(storage.data(), storage.size()),
+            entry.fulllength};
+}
+
+[[nodiscard]] auto inflateToFile(
+        ExtractContext const& context, path const& outname,
+        ObbEntry const& entry) -> bool {
+    Console&          console = context.console;
+    OutputTree const& tree    = *context.tree;
+    OutputMapping     output(tree, outname, entry.fulllength);
+    if (!output.valid()) {
+        console.error(
+                "Could not create file "sv, tree.fullPath(outname), "!"sv);
+        return false;
+    }
+    checkInflated(
+            inflateEntry(
+                    context.checkpoints, context.obb, entry, output.data()),
+            entry);
+    if (!output.commit()) {
+        console.error(
+                "Could not write file "sv, tree.fullPath(outname), "!"sv);
+        return false;
+    }
+    return true;
+}
+
+// Creates the directories of all files that are going to be written, once
+// each, before any worker starts. Files whose directory could not be created
+// are reported here, and skipped later.
+void createDirectories(
+        Console& console, OutputTree& tree, vector<path> const& outnames) {
+    for (path const& outname : outnames) {
+        if (!tree.addDirectory(outname.parent_path())) {
+            console.error(
+                    "Could not create directory "sv,
+                    tree.fullPath(outname.parent_path()), " for file "sv,
+                    tree.fullPath(outname), "!"sv);
+        }
+    }
+}
+
+// Decodes the extracted form of an entry into memory.
+[[nodiscard]] auto decodeToBuffer(
+        ExtractContext const& context, zlib_decompressor& unzip,
+        ObbEntry const& entry, path const& outname, bool isReference)
+        -> vector<char> {
+    // The reference file is not an entry of the OBB; the filters build it.
+    vector<char>   storage;
+    ObbEntry const input
+            = isReference ? entry : decodeInput(context, entry, storage);
+    vector<char>   buffer;
+    buffer.reserve(entry.fulllength);
+    filtering_ostream fsout;
+    pushDecodeFilters(
+            fsout, unzip, outname, context.inkData, input.compressed(),
+            isReference);
+    fsout.push(boost::iostreams::back_inserter(buffer));
+    fsout << input.data;
+    fsout.reset();
+    return buffer;
+}
+
+// Returns false if the file could not be written.
+[[nodiscard]] auto decodeFile(
+        ExtractContext const& context, zlib_decompressor& unzip,
+        ObbEntry const& entry, bool isReference) -> bool {
+    Console&          console = context.console;
+    OutputTree const& tree    = *context.tree;
+    path const        outname(outputName(entry.name));
+    path const        outfile(tree.fullPath(outname));
+    // Stored entries that need no processing are copied as they are, going
+    // through the kernel when possible.
+    if (isVerbatim(entry, outname, isReference)) {
+        if (!writeWholeFile(
+                    tree, outname, entry.data, context.obbfd,
+                    context.obb.offsetOf(entry))) {
+            console.error("Could not write file "sv, outfile, "!"sv);
+            return false;
+        }
+        return true;
+    }
+    // Other compressed entries are inflated in one go into the mapped output
+    // file, as their size is known in advance.
+    if (!isReference && !isJsonFile(outname)) {
+        return inflateToFile(context, outname, entry);
+    }
+    std::unique_ptr<std::ostream> const fout = tree.createStream(outname);
+    if (!fout) {
+        console.error("Could not create file "sv, outfile, "!"sv);
+        return false;
+    }
+    // Large JSON files are inflated, formatted and written concurrently.
+    if (!isReference && entry.fulllength >= JsonPipelineMinSize) {
+        vector<InflateCheckpoint> points;
+        checkInflated(
+                pipeJson(
+                        entry, *fout,
+                        context.checkpoints != nullptr ? &points : nullptr),
+                entry);
+        if (context.checkpoints != nullptr) {
+            context.checkpoints->add(context.obb, entry, std::move(points));
+        }
+        fout->flush();
+        if (!fout->good()) {
+            console.error("Could not write file "sv, outfile, "!"sv);
+            return false;
+        }
+        return true;
+    }
+    if (isReference) {
+        console.progress("Creating reference file "sv, outfile);
+    }
+    // The reference file is not an entry of the OBB; the filters build it.
+    vector<char>      storage;
+    ObbEntry const    input
+            = isReference ? entry : decodeInput(context, entry, storage);
+    filtering_ostream fsout;
+    pushDecodeFilters(
+            fsout, unzip, outfile, context.inkData, input.compressed(),
+            isReference);
+    fsout.push(*fout);
+    fsout << input.data;
+    fsout.reset();
+    if (!fout->good()) {
+        console.error("Could not write file "sv, outfile, "!"sv);
+        return false;
+    }
+    return true;
+}
+
+// Decodes an entry in memory, and queues it to be written by the io_uring
+// writer. Returns the size and hash of the file as it will be written.
+[[nodiscard]] auto queueFile(
+        ExtractContext const& context, zlib_decompressor& unzip,
+        ObbEntry const& entry, uint64_t storedHash) -> optional<FileHash> {
+    path const outname(outputName(entry.name));
+    UniqueFd   file = context.tree->createFile(outname);
+    if (!file) {
+        context.console.error(
+                "Could not create file "sv, context.tree->fullPath(outname),
+                "!"sv);
+        return std::nullopt;
+    }
+    // Stored entries are written straight from the mapping.
+    if (isVerbatim(entry, outname, false)) {
+        context.uring->write(std::move(file), entry.data, entry.name);
+        return FileHash{entry.data.size(), storedHash};
+    }
+    vector<char> buffer;
+    if (isJsonFile(outname)) {
+        buffer = decodeToBuffer(context, unzip, entry, outname, false);
+    } else {
+        buffer.resize(entry.fulllength);
+        checkInflated(
+                inflateEntry(
+                        context.checkpoints, context.obb, entry,
+                        buffer.data()),
+                entry);
+    }
+    FileHash const written{
+            buffer.size(), hashData(string_view(buffer.data(), buffer.size()))};
+    context.uring->write(std::move(file), std::move(buffer), entry.name);
+    return written;
+}
+
+// Roughly the most memory extracting an entry takes at any one time, beyond
+// its data in the OBB mapping, for the memory budget.
+[[nodiscard]] auto footprintOf(
+        ExtractContext const& context, ObbEntry const& entry,
+        bool isReference) -> size_t {
+    path const   outname(outputName(entry.name));
+    size_t const size = entry.fulllength;
     if (isReference) {
-        cout << "done."sv << flush;
+        // It takes in the whole inkcontent as well.
+        size_t const full = size + context.inkData.size();
+        return context.tree == nullptr ? full * 4U : full * 5U / 2U;
+    }
+    if (isVerbatim(entry, outname, false)) {
+        return 0U;
+    }
+    bool const toBuffer
+            = context.tree == nullptr
+              || (context.uring != nullptr && size <= UringWriter::MaxFileSize
+                  && entry.data.size() <= UringWriter::MaxFileSize);
+    if (!isJsonFile(outname)) {
+        // The inflated file, either in memory or as dirty pages of the
+        // mapped output file.
+        return size;
+    }
+    if (!toBuffer && size >= JsonPipelineMinSize) {
+        // The inflated document, and the formatted chunks in flight.
+        return size + size_t{1U} * 1024U * 1024U;
+    }
+    // The inflated document and the formatted output, which is about half
+    // as large again, in the filter; and a copy of the latter when decoding
+    // into memory, along with the entry if it is inflated up front.
+    size_t const upfront = inflatesUpFront(context, entry) ? size : 0U;
+    return (toBuffer ? size * 4U : size * 5U / 2U) + upfront;
+}
+
+// Orders entries by priority; within each class, they keep their order,
+// which is by position. With a memory budget, the entries of a class which
+// take more than a worker's share of it are moved to its front, largest
+// first: if they started last, they would run with the other workers idle,
+// waiting on the budget. The rest stay in position order, so reads from the
+// OBB remain mostly sequential.
+template <typename PriorityOf, typename Footprint>
+void scheduleEntries(
+        vector<size_t>& order, MemoryBudget const& budget, unsigned numThreads,
+        PriorityOf const& priority, Footprint const& footprint) {
+    std::stable_sort(
+            order.begin(), order.end(),
+            [&](size_t const lhs, size_t const rhs) {
+                return priority(lhs) < priority(rhs);
+            });
+    if (!budget.enabled()) {
+        return;
+    }
+    size_t const share = budget.capacity() / std::max(1U, numThreads);
+    for (auto first = order.begin(); first != order.end();) {
+        Priority const current = priority(*first);
+        auto const     last    = std::find_if(
+                first, order.end(),
+                [&](size_t const index) { return priority(index) != current; });
+        auto const large = std::stable_partition(
+                first, last,
+                [&](size_t const index) { return footprint(index) > share; });
+        std::stable_sort(
+                first, large, [&](size_t const lhs, size_t const rhs) {
+                    return footprint(lhs) > footprint(rhs);
+                });
+        first = last;
+    }
+}
+
+// The manifest record for an entry, without the output fields.
+[[nodiscard]] __attribute__((pure)) auto sourceRecord(
+        ExtractContext const& context, ObbEntry const& entry,
+        uint64_t storedHash) -> ManifestRecord {
+    return {context.obb.offsetOf(entry),
+            static_cast<uint32_t>(entry.data.size()), entry.fulllength,
+            storedHash};
+}
+
+// The record of the previous run for the entry, if it came from the same
+// source and the file on disk is still what that run wrote.
+[[nodiscard]] auto findUpToDate(
+        ExtractContext const& context, ObbEntry const& entry,
+        path const& outname, ManifestRecord const& record)
+        -> optional<ManifestRecord> {
+    if (context.force) {
+        return std::nullopt;
     }
+    return ::findUpToDate(
+            context.previous, entry.name, record, *context.tree, outname);
+}
+
+// Extracts an entry, unless the manifest of the previous run shows that the
+// file on disk is still up to date. Returns the manifest record for the file,
+// or nothing if it could not be extracted. The file is reported to the event
+// log, except when it is queued for io_uring; that reports it once written.
+[[nodiscard]] auto updateFile(
+        ExtractContext const& context, zlib_decompressor& unzip,
+        ObbEntry const& entry, uint64_t storedHash, bool isReference)
+        -> optional<ManifestRecord> {
+    ManifestRecord    record = sourceRecord(context, entry, storedHash);
+    OutputTree const& tree   = *context.tree;
+    path const        outname(outputName(entry.name));
+    // Its directory could not be created, which was already reported.
+    if (!tree.hasDirectory(outname.parent_path())) {
+        announce(context, "failed"sv, entry.name);
+        return std::nullopt;
+    }
+    if (auto const current = findUpToDate(context, entry, outname, record)) {
+        announce(context, "unchanged"sv, entry.name);
+        return current;
+    }
+    // The previous run may have hard linked the file to its duplicates, which
+    // must not change along with it.
+    if (context.previous.count(entry.name) != 0) {
+        tree.removeFile(outname);
+    }
+    if (!isReference) {
+        context.console.progress("Extracting file "sv, entry.name);
+    }
+    if (context.uring != nullptr && !isReference
+        && entry.fulllength <= UringWriter::MaxFileSize
+        && entry.data.size() <= UringWriter::MaxFileSize) {
+        auto const queued = queueFile(context, unzip, entry, storedHash);
+        if (!queued) {
+            announce(context, "failed"sv, entry.name);
+            return std::nullopt;
+        }
+        record.outputSize = queued->size;
+        record.outputHash = queued->hash;
+        return record;
+    }
+    if (!decodeFile(context, unzip, entry, isReference)) {
+        announce(context, "failed"sv, entry.name);
+        return std::nullopt;
+    }
+    if (isVerbatim(entry, outname, isReference)) {
+        record.outputSize = entry.data.size();
+        record.outputHash = storedHash;
+        announce(context, "written"sv, entry.name);
+        return record;
+    }
+    auto const written = hashFile(tree, outname);
+    if (!written) {
+        announce(context, "failed"sv, entry.name);
+        return std::nullopt;
+    }
+    record.outputSize = written->size;
+    record.outputHash = written->hash;
+    announce(context, "written"sv, entry.name);
+    return record;
+}
+
+// Adds the extracted form of an entry to a tar stream. Stored entries that
+// need no filtering are written straight from the mapping; everything else is
+// decoded into memory first, as the tar header needs the final size.
+void decodeToTar(
+        ExtractContext const& context, TarWriter& tar,
+        zlib_decompressor& unzip, ObbEntry const& entry, bool isReference) {
+    Console&     console = context.console;
+    path const   outname(outputName(entry.name));
+    string const name(outname.generic_string());
+    if (isVerbatim(entry, outname, isReference)) {
+        tar.addFile(name, entry.data);
+        return;
+    }
+    if (isReference) {
+        console.progress("Creating reference file "sv, name);
+    }
+    vector<char> const buffer
+            = decodeToBuffer(context, unzip, entry, outname, isReference);
+    tar.addFile(name, string_view(buffer.data(), buffer.size()));
+}
+
+// Runs extractOne on the indices of count entries using numThreads workers,
+// each with its own decompressor. Each worker grabs the next unclaimed entry,
+// so workers that finish small files early keep taking work while others are
+// still busy with large ones. Entries are claimed in order, which keeps reads
+// from the OBB mostly sequential when they are sorted by data position.
+template <typename Callback>
+void extractEntries(
+        size_t count, unsigned numThreads, Callback const& extractOne) {
+    atomic<size_t> nextEntry{0};
+    atomic<bool>   failed{false};
+    exception_ptr  firstError;
+    mutex          errorMutex;
+
+    auto worker = [&]() {
+        try {
+            zlib_decompressor unzip(
+                    zlib::default_window_bits, 1ULL * 1024ULL * 1024ULL);
+            while (!failed) {
+                size_t const index = nextEntry++;
+                if (index >= count) {
+                    return;
+                }
+                extractOne(unzip, index);
+            }
+        } catch (...) {
+            lock_guard<mutex> lock(errorMutex);
+            if (!failed.exchange(true)) {
+                firstError = std::current_exception();
+            }
+        }
+    };
+
+    numThreads = static_cast<unsigned>(std::max<size_t>(
+            1U, std::min<size_t>(numThreads, count)));
+    vector<thread> workers;
+    workers.reserve(numThreads - 1);
+    for (unsigned ii = 1; ii < numThreads; ii++) {
+        workers.emplace_back(worker);
+    }
+    // The main thread does its share of the work as well.
+    worker();
+    for (auto& elem : workers) {
+        elem.join();
+    }
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+constexpr char const* const FileTableName = "FileTable.idx";
+constexpr char const* const ManifestName  = "FileTable.manifest";
+
+// Both lists are sorted by position in the OBB, and extracted is a subset of
+// entries with hashes holding the hash of each of its members.
+[[nodiscard]] auto formatFileIndex(
+        ObbArchive const& obb, vector<ObbEntry> const& entries,
+        vector<ObbEntry> const& extracted, vector<uint64_t> const& hashes)
+        -> string {
+    vector<FileIndex::Record> records;
+    records.reserve(entries.size());
+    size_t next = 0;
+    for (auto const& elem : entries) {
+        FileIndex::Record record;
+        record.name       = elem.name;
+        record.offset     = obb.offsetOf(elem);
+        record.complength = static_cast<uint32_t>(elem.data.size());
+        record.fulllength = elem.fulllength;
+        record.compressed = elem.compressed();
+        if (next < extracted.size()
+            && extracted[next].name.data() == elem.name.data()) {
+            record.hasChecksum = true;
+            record.checksum    = hashes[next++];
+        }
+        records.push_back(record);
+    }
+    return FileIndex::format(records);
+}
+
+// Makes room for the timings of count entries; returns the index of the
+// first.
+[[nodiscard]] auto reserveStats(ExtractContext const& context, size_t count)
+        -> size_t {
+    return context.stats != nullptr ? context.stats->reserveEntries(count) : 0;
+}
+
+void recordStats(
+        ExtractContext const& context, size_t index, ObbEntry const& entry,
+        Stopwatch const& timer) {
+    if (context.stats != nullptr) {
+        context.stats->entry(index) = EntryStats{
+                string(entry.name), entry.data.size(), entry.fulllength,
+                timer.elapsed()};
+    }
+}
+
+void addPhase(
+        ExtractContext const& context, string_view const name,
+        Stopwatch& phase) {
+    if (context.stats != nullptr) {
+        context.stats->addPhase(name, phase.lap());
+    }
+}
+
+// The data of the given entries, for a ReadWindow over them.
+[[nodiscard]] auto dataOf(
+        vector<ObbEntry> const& entries, vector<size_t> const& order)
+        -> vector<string_view> {
+    vector<string_view> items;
+    items.reserve(order.size());
+    for (size_t const index : order) {
+        items.push_back(entries[index].data);
+    }
+    return items;
+}
+
+// The indices of all entries, in order.
+[[nodiscard]] auto allOf(vector<ObbEntry> const& entries) -> vector<size_t> {
+    vector<size_t> order(entries.size());
+    std::iota(order.begin(), order.end(), size_t{0U});
+    return order;
+}
+
+// The reference file is built alongside the selected entries.
+[[nodiscard]] auto extractToTar(
+        ExtractContext const& context, TarWriter& tar,
+        vector<ObbEntry> const& selected, optional<ObbEntry> const& reference,
+        StoryFiles const& story, unsigned numThreads, size_t windowSize,
+        MemoryBudget& budget) -> vector<uint64_t> {
+    vector<uint64_t> hashes(selected.size());
+    Stopwatch        phase;
+    vector<ObbEntry> entries(selected);
+    if (reference) {
+        entries.push_back(*reference);
+    }
+    auto const isReference = [&](size_t const index) {
+        return index == selected.size();
+    };
+    size_t const   firstStats = reserveStats(context, entries.size());
+    vector<size_t> order      = allOf(entries);
+    // Moves the reference to the front of its class.
+    std::rotate(
+            order.begin(),
+            order.begin() + static_cast<ptrdiff_t>(selected.size()),
+            order.end());
+    scheduleEntries(
+            order, budget, numThreads,
+            [&](size_t const index) {
+                return priorityOf(story, entries[index], isReference(index));
+            },
+            [&](size_t const index) {
+                return footprintOf(
+                        context, entries[index], isReference(index));
+            });
+    ReadWindow window(
+            context.obb.contents(), context.obbfd.get(), windowSize,
+            dataOf(entries, order));
+    extractEntries(
+            entries.size(), numThreads,
+            [&](zlib_decompressor& unzip, size_t item) {
+                Stopwatch const     timer;
+                size_t const        index = order[item];
+                ObbEntry const&     entry = entries[index];
+                bool const          ref   = isReference(index);
+                MemoryBudget::Lease lease(
+                        budget, footprintOf(context, entry, ref));
+                if (!ref) {
+                    context.console.progress("Extracting file "sv, entry.name);
+                }
+                window.claim(item);
+                if (!ref) {
+                    hashes[index] = hashData(entry.data);
+                }
+                decodeToTar(context, tar, unzip, entry, ref);
+                window.finish(item);
+                recordStats(context, firstStats + index, entry, timer);
+            });
+    addPhase(context, "extraction"sv, phase);
+    return hashes;
+}
+
+// Compares two OBBs, only decompressing the entries whose file table records
+// and stored data do not tell whether they changed.
+[[nodiscard]] auto diffArchives(
+        ObbArchive const& older, ObbArchive const& newer,
+        NameFilter const& filter, unsigned numThreads) -> ObbDiff {
+    ObbDiff diff = compareTables(older, newer, filter);
+    // Not vector<bool>, as each worker sets its own elements.
+    vector<char> same(diff.ambiguous.size());
+    extractEntries(
+            diff.ambiguous.size(), numThreads,
+            [&](zlib_decompressor&, size_t index) {
+                same[index] = sameContents(diff.ambiguous[index]) ? 1 : 0;
+            });
+    size_t const sorted = diff.modified.size();
+    for (size_t ii = 0; ii < diff.ambiguous.size(); ii++) {
+        if (same[ii] != 0) {
+            diff.unchanged++;
+        } else {
+            diff.modified.push_back(diff.ambiguous[ii]);
+        }
+    }
+    diff.ambiguous.clear();
+    // Both parts are sorted by name.
+    std::inplace_merge(
+            diff.modified.begin(),
+            diff.modified.begin() + static_cast<ptrdiff_t>(sorted),
+            diff.modified.end(),
+            [](EntryPair const& lhs, EntryPair const& rhs) {
+                return lhs.older.name < rhs.older.name;
+            });
+    return diff;
+}
+
+// Checks that every entry lies inside the OBB, and that compressed entries
+// inflate to the size in the file table, without writing anything except for
+// the checkpoints of the inflate index, if there is one. Reports the first
+// failure and returns false.
+[[nodiscard]] auto verifyArchive(
+        Console& console, ObbArchive const& obb, UniqueFd const& obbfd,
+        unsigned numThreads, size_t windowSize,
+        CheckpointCollector* checkpoints) -> bool {
+    vector<ObbEntry> entries;
+    try {
+        EntryTable const table(obb);
+        entries.reserve(table.size());
+        // Sort by data order in file, to improve OS prefetching.
+        for (uint32_t const index : table.byPosition()) {
+            entries.push_back(table.entry(index));
+        }
+    } catch (bad_obb const& except) {
+        console.error(except.what());
+        return false;
+    }
+
+    ReadWindow window(
+            obb.contents(), obbfd.get(), windowSize,
+            dataOf(entries, allOf(entries)));
+    try {
+        extractEntries(
+                entries.size(), numThreads,
+                [&](zlib_decompressor&, size_t index) {
+                    ObbEntry const& entry = entries[index];
+                    if (!entry.compressed()) {
+                        window.finish(index);
+                        return;
+                    }
+                    console.progress("Verifying file "sv, entry.name);
+                    window.claim(index);
+                    // Reused by all entries a worker checks.
+                    thread_local vector<char> scratch;
+                    scratch.resize(entry.fulllength);
+                    InflateStatus const status = inflateEntry(
+                            checkpoints, obb, entry, scratch.data());
+                    if (status == InflateStatus::eSIZE_MISMATCH) {
+                        throw bad_obb(
+                                bad_obb::eCORRUPT,
+                                "File "s + string(entry.name)
+                                        + ": decompressed size does not "
+                                          "match file table!"s);
+                    }
+                    if (status != InflateStatus::eOK) {
+                        throw bad_obb(
+                                bad_obb::eCORRUPT,
+                                "File "s + string(entry.name)
+                                        + ": invalid compressed data!"s);
+                    }
+                    window.finish(index);
+                });
+    } catch (bad_obb const& except) {
+        console.error(except.what());
+        return false;
+    }
+    console.line("Verified "sv, entries.size(), " files."sv);
+    return true;
+}
+
+void usage(ostream& out, string_view const program) {
+    out << "Usage: "sv << program
+        << " [options] inputfile outputdir\n"
+           "Usage: "sv
+        << program
+        << " [options] --tar FILE inputfile\n"
+           "Usage: "sv
+        << program
+        << " [options] --batch OBB:OUTDIR[:LINKDIR]...\n"
+           "Usage: "sv
+        << program
+        << " [-j N] [--inflate-index FILE] --verify inputfile\n"
+           "Usage: "sv
+        << program
+        << " [filters] --list [--json] [--sort KEY] [--reverse] inputfile\n"
+           "Usage: "sv
+        << program
+        << " [-j N] [filters] --diff [--json] old.obb new.obb\n"
+           "Usage: "sv
+        << program << " [--inflate-index FILE] --stitch NAME inputfile\n\n"
+           "Where options are:\n"
+           "\t-h, --help\n"
+           "\t\tDisplays this message.\n"
+           "\t-f, --force\n"
+           "\t\tExtracts all files, even those which are up to date.\n"
+           "\t-j N\tExtracts using N threads; 0 means one per CPU core.\n"
+           "\t\tThe default is 1.\n"
+           "\t--no-dedup\n"
+           "\t\tExtracts identical files separately instead of linking\n"
+           "\t\tthem to a single copy.\n"
+           "\t--window MB\n"
+           "\t\tKeeps only about MB megabytes of the OBB in memory while\n"
+           "\t\textracting or verifying: data ahead of the files being\n"
+           "\t\tread is prefetched, and data behind them is dropped.\n"
+           "\t\tThe default, 0, leaves it all to the OS.\n"
+           "\t--max-memory MB\n"
+           "\t\tOnly extracts as many files at once as fit in about MB\n"
+           "\t\tmegabytes, going by their sizes, and starts with the\n"
+           "\t\tlargest. The default, 0, means no limit.\n"
+           "\t--codec NAME\n"
+           "\t\tInflates whole files with the backend NAME. This build\n"
+           "\t\thas "sv
+        << codecBackendNames()
+        << "; the default is the first,\n"
+           "\t\twhich is the fastest.\n"
+           "\t--io-uring\n"
+           "\t\tWrites small files through io_uring where supported.\n"
+           "\t--include GLOB, --include-regex REGEX\n"
+           "\t\tOnly extracts files whose names match. Can be repeated.\n"
+           "\t--exclude GLOB, --exclude-regex REGEX\n"
+           "\t\tDoes not extract files whose names match. Can be repeated.\n"
+           "\t--from-list FILE\n"
+           "\t\tOnly extracts files named in FILE, one name per line.\n"
+           "\t--tar FILE\n"
+           "\t\tWrites the extracted files as a tar archive to FILE instead\n"
+           "\t\tof into an output directory. Use '-' for stdout.\n"
+           "\t--batch\n"
+           "\t\tExtracts several OBBs using one set of threads. Each\n"
+           "\t\targument is OBB:OUTDIR, or OBB:OUTDIR:LINKDIR to also link\n"
+           "\t\tthe JSON files into LINKDIR for easier browsing.\n"
+           "\t--events FD|FILE\n"
+           "\t\tReports each file as soon as it is done as a line of JSON\n"
+           "\t\tto the file descriptor FD, or to FILE, which can be a named\n"
+           "\t\tpipe.\n"
+           "\t--inflate-index FILE\n"
+           "\t\tSaves checkpoints of the large compressed files to FILE\n"
+           "\t\twhile extracting or verifying, so that --stitch can later\n"
+           "\t\tread from the middle of them without inflating all that\n"
+           "\t\tcomes before. Checkpoints of files which are skipped are\n"
+           "\t\tkept from an existing FILE while they are still valid.\n"
+           "\t--stats FILE\n"
+           "\t\tWrites the time taken by each phase and by each file, and\n"
+           "\t\tthe overall throughput, as JSON to FILE.\n"
+           "\t--verify\n"
+           "\t\tChecks that the OBB is intact by inflating all of its files\n"
+           "\t\tin memory, without extracting anything.\n"
+           "\t--list\n"
+           "\t\tLists the files in the OBB with their offset, compressed and\n"
+           "\t\tuncompressed sizes, ratio and whether they are compressed,\n"
+           "\t\tas tab-separated values, without decompressing anything.\n"
+           "\t\tThe filters select which files are listed.\n"
+           "\t--diff\n"
+           "\t\tLists the files added, removed and modified between two\n"
+           "\t\tOBBs, as tab-separated values. Files are compared by their\n"
+           "\t\tsizes and stored data, and only decompressed when that is\n"
+           "\t\tnot enough to tell. The filters select which files are\n"
+           "\t\tcompared.\n"
+           "\t--stitch NAME\n"
+           "\t\tPrints the stitch NAME as it appears in the reference\n"
+           "\t\tfile, only decompressing as much as it takes to find it.\n"
+           "\t\tWith --inflate-index, uses the checkpoints in FILE.\n"
+           "\t--json\tLists or compares as JSON instead.\n"
+           "\t--sort KEY\n"
+           "\t\tSorts the list by name (the default), offset, compressed,\n"
+           "\t\tsize or ratio.\n"
+           "\t--reverse\n"
+           "\t\tSorts the list in descending order.\n\n"
+           "Globs use '*', '?' and '[...]'; '*' also matches '/'. Patterns\n"
+           "must match the whole file name as stored in the OBB. The\n"
+           "reference file is extracted if its name is selected.\n\n"sv;
+}
+
+[[nodiscard]] auto parseThreadCount(string_view const value) -> unsigned {
+    char const*   first = value.data();
+    char*         last  = nullptr;
+    unsigned long count = std::strtoul(first, &last, 10);
+    if (value.empty() || last != first + value.size() || count > 1024UL) {
+        cerr << "Invalid thread count '"sv << value << "'!"sv << endl << endl;
+        throw ErrorCodes{eINVALID_ARGS};
+    }
+    if (count == 0) {
+        count = std::max(1U, thread::hardware_concurrency());
+    }
+    return static_cast<unsigned>(count);
+}
+
+// Parses a size in megabytes, up to 1 TiB; what names it in errors.
+[[nodiscard]] auto parseMegabytes(
+        string_view const value, string_view const what) -> size_t {
+    char const*   first = value.data();
+    char*         last  = nullptr;
+    unsigned long size  = std::strtoul(first, &last, 10);
+    if (value.empty() || last != first + value.size() || size > 1048576UL) {
+        cerr << "Invalid "sv << what << " '"sv << value << "'!"sv << endl
+             << endl;
+        throw ErrorCodes{eINVALID_ARGS};
+    }
+    return size * 1024U * 1024U;
+}
+
+// An OBB and where to extract it to.
+struct Target {
+    path obbfile;
+    path outdir;
+    // Where to link the JSON files to; empty if not wanted.
+    path linkdir;
+};
+
+struct Options {
+    unsigned   numThreads = 1;
+    NameFilter filter;
+    // Only batch mode has more than one.
+    vector<Target> targets;
+    // Empty when extracting to a directory; "-" means stdout.
+    string tarfile;
+    // Extract all files, even those the manifest says are up to date.
+    bool force = false;
+    // Only check the OBB; there is no output.
+    bool verify = false;
+    // Decode identical entries once, and link the other files to it.
+    bool dedup = true;
+    // Bytes of the OBB to keep in memory around the entries being read; 0
+    // means no limit.
+    size_t windowSize = 0;
+    // Bytes that the entries being extracted at the same time may take; 0
+    // means no limit.
+    size_t maxMemory = 0;
+    // Write small files through io_uring, if the kernel supports it.
+    bool ioUring = false;
+    // Where to write timings of the run; empty if not wanted.
+    string statsfile;
+    // File descriptor or file to report finished files to; empty if not
+    // wanted.
+    string events;
+    // Extract several OBBs, given as OBB:OUTDIR[:LINKDIR].
+    bool batch = false;
+    // Only list the contents of the OBB; there is no output directory.
+    bool       list       = false;
+    ListFormat listFormat = ListFormat::eTSV;
+    ListOrder  listOrder  = ListOrder::eName;
+    bool       reverse    = false;
+    // Compare two OBBs, given as the two targets; there is no output
+    // directory.
+    bool diff = false;
+    // Only print this stitch from the OBB; empty if not wanted.
+    string stitch;
+    // Inflate index to write while extracting or verifying, or to read the
+    // stitch with; empty if not wanted.
+    string inflateIndex;
+    // Backend for inflating whole entries; the fastest one if not given.
+    optional<CodecBackend> codec;
+};
+
+// Splits OBB:OUTDIR[:LINKDIR] for batch mode.
+[[nodiscard]] auto parseTarget(string_view const spec) -> Target {
+    size_t const first = spec.find(':');
+    if (first == string_view::npos) {
+        cerr << "Invalid batch target '"sv << spec
+             << "'; expected OBB:OUTDIR or OBB:OUTDIR:LINKDIR!"sv << endl
+             << endl;
+        throw ErrorCodes{eINVALID_ARGS};
+    }
+    size_t const second = spec.find(':', first + 1);
+    Target       target;
+    target.obbfile = string(spec.substr(0, first));
+    target.outdir  = string(spec.substr(first + 1, second - first - 1));
+    if (second != string_view::npos) {
+        target.linkdir = string(spec.substr(second + 1));
+    }
+    if (target.obbfile.empty() || target.outdir.empty()
+        || (second != string_view::npos && target.linkdir.empty())) {
+        cerr << "Invalid batch target '"sv << spec << "'!"sv << endl << endl;
+        throw ErrorCodes{eINVALID_ARGS};
+    }
+    return target;
+}
+
+[[nodiscard]] auto parseArguments(int argc, char* argv[]) -> Options {
+    string_view const   program(argv[0]);
+    Options             options;
+    vector<char const*> positional;
+    for (int ii = 1; ii < argc; ii++) {
+        string_view const arg(argv[ii]);
+        string_view       value;
+        // Accepts "--option value" and "--option=value" for long options,
+        // and "-o value" and "-ovalue" for short ones.
+        auto hasValue = [&](string_view const name) {
+            if (arg == name) {
+                if (++ii == argc) {
+                    cerr << "Missing value for option "sv << name << "!"sv
+                         << endl
+                         << endl;
+                    throw ErrorCodes{eWRONG_ARGC};
+                }
+                value = argv[ii];
+                return true;
+            }
+            if (arg.substr(0, name.size()) != name) {
+                return false;
+            }
+            if (name.size() == 2) {
+                value = arg.substr(2);
+                return true;
+            }
+            if (arg[name.size()] == '=') {
+                value = arg.substr(name.size() + 1);
+                return true;
+            }
+            return false;
+        };
+        try {
+            if (arg == "-h"sv || arg == "--help"sv) {
+                usage(cout, program);
+                throw ErrorCodes{eOK};
+            }
+            if (arg == "-f"sv || arg == "--force"sv) {
+                options.force = true;
+            } else if (arg == "--verify"sv) {
+                options.verify = true;
+            } else if (arg == "--no-dedup"sv) {
+                options.dedup = false;
+            } else if (arg == "--io-uring"sv) {
+                options.ioUring = true;
+            } else if (arg == "--batch"sv) {
+                options.batch = true;
+            } else if (arg == "--list"sv) {
+                options.list = true;
+            } else if (arg == "--diff"sv) {
+                options.diff = true;
+            } else if (arg == "--json"sv) {
+                options.listFormat = ListFormat::eJSON;
+            } else if (arg == "--reverse"sv) {
+                options.reverse = true;
+            } else if (hasValue("--sort"sv)) {
+                auto const order = parseListOrder(value);
+                if (!order) {
+                    cerr << "Invalid sort key '"sv << value << "'!"sv << endl
+                         << endl;
+                    throw ErrorCodes{eINVALID_ARGS};
+                }
+                options.listOrder = *order;
+            } else if (hasValue("-j"sv)) {
+                options.numThreads = parseThreadCount(value);
+            } else if (hasValue("--window"sv)) {
+                options.windowSize = parseMegabytes(value, "window size"sv);
+            } else if (hasValue("--max-memory"sv)) {
+                options.maxMemory = parseMegabytes(value, "memory budget"sv);
+            } else if (hasValue("--include"sv)) {
+                options.filter.include(value);
+            } else if (hasValue("--include-regex"sv)) {
+                options.filter.includeRegex(value);
+            } else if (hasValue("--exclude"sv)) {
+                options.filter.exclude(value);
+            } else if (hasValue("--exclude-regex"sv)) {
+                options.filter.excludeRegex(value);
+            } else if (hasValue("--tar"sv)) {
+                options.tarfile = value;
+            } else if (hasValue("--stats"sv)) {
+                options.statsfile = value;
+            } else if (hasValue("--stitch"sv)) {
+                options.stitch = value;
+                if (options.stitch.empty()) {
+                    cerr << "Invalid stitch name ''!"sv << endl << endl;
+                    throw ErrorCodes{eINVALID_ARGS};
+                }
+            } else if (hasValue("--events"sv)) {
+                options.events = value;
+            } else if (hasValue("--inflate-index"sv)) {
+                options.inflateIndex = value;
+            } else if (hasValue("--codec"sv)) {
+                options.codec = findCodecBackend(value);
+                if (!options.codec) {
+                    cerr << "Codec '"sv << value
+                         << "' is not available; this build has "sv
+                         << codecBackendNames() << "."sv << endl
+                         << endl;
+                    throw ErrorCodes{eINVALID_ARGS};
+                }
+            } else if (hasValue("--from-list"sv)) {
+                path const listfile{string(value)};
+                ifstream   list(listfile, ios::in);
+                if (!list.good()) {
+                    cerr << "Could not open list file "sv << listfile << "!"sv
+                         << endl
+                         << endl;
+                    throw ErrorCodes{eINVALID_ARGS};
+                }
+                options.filter.includeList(list);
+            } else if (arg.size() > 1 && arg[0] == '-') {
+                cerr << "Unknown option '"sv << arg << "'!"sv << endl << endl;
+                usage(cerr, program);
+                throw ErrorCodes{eINVALID_ARGS};
+            } else {
+                positional.push_back(argv[ii]);
+            }
+        } catch (std::regex_error const& except) {
+            cerr << "Invalid regular expression '"sv << value
+                 << "': "sv << except.what() << endl
+                 << endl;
+            throw ErrorCodes{eINVALID_ARGS};
+        }
+    }
+    bool const listOptions
+            = options.listOrder != ListOrder::eName || options.reverse;
+    bool const stitch = !options.stitch.empty();
+    bool const report = options.list || options.diff || stitch;
+    if ((report
+         && (options.batch || options.verify || !options.tarfile.empty()
+             || !options.statsfile.empty()))
+        || (!options.events.empty()
+            && (report || options.verify || !options.tarfile.empty()))
+        || (!options.inflateIndex.empty()
+            && (options.batch || options.list || options.diff))
+        || (int{options.list} + int{options.diff} + int{stitch} > 1)
+        || (listOptions && !options.list)
+        || (options.listFormat != ListFormat::eTSV
+            && !options.list && !options.diff)) {
+        usage(cerr, program);
+        throw ErrorCodes{eWRONG_ARGC};
+    }
+    if (options.diff) {
+        if (positional.size() != 2U) {
+            usage(cerr, program);
+            throw ErrorCodes{eWRONG_ARGC};
+        }
+        for (char const* obbfile : positional) {
+            Target target;
+            target.obbfile = obbfile;
+            options.targets.push_back(target);
+        }
+        return options;
+    }
+    if (options.batch) {
+        if (positional.empty() || options.verify
+            || !options.tarfile.empty()) {
+            usage(cerr, program);
+            throw ErrorCodes{eWRONG_ARGC};
+        }
+        for (char const* spec : positional) {
+            options.targets.push_back(parseTarget(spec));
+        }
+        return options;
+    }
+    bool const needsOutdir = options.tarfile.empty() && !options.verify
+                             && !options.list && !stitch;
+    if (positional.size() != (needsOutdir ? 2U : 1U)
+        || (options.verify
+            && (!options.tarfile.empty() || !options.statsfile.empty()))) {
+        usage(cerr, program);
+        throw ErrorCodes{eWRONG_ARGC};
+    }
+    Target target;
+    target.obbfile = positional[0];
+    if (needsOutdir) {
+        target.outdir = positional[1];
+    }
+    options.targets.push_back(target);
+    return options;
+}
+
+// An OBB opened for extraction, and the entries selected from it.
+struct Archive {
+    path       obbfile;
+    ObbArchive obb;
+    StoryFiles story;
+    // All entries, sorted by position in the OBB.
+    vector<ObbEntry> entries;
+    // The entries to extract, in the same order.
+    vector<ObbEntry> selected;
+    string           referenceName;
+    // The reference file, if selected; its name points into referenceName.
+    optional<ObbEntry> reference;
+    string_view        inkData;
+    UniqueFd           obbfd;
+
+    Archive(path _obbfile, ObbArchive _obb)
+            : obbfile(std::move(_obbfile)), obb(std::move(_obb)) {}
+    Archive(Archive const&) = delete;
+    Archive(Archive&&)      = delete;
+    auto operator=(Archive const&) -> Archive& = delete;
+    auto operator=(Archive&&) -> Archive& = delete;
+    ~Archive() noexcept = default;
+};
+
+[[nodiscard]] auto loadArchive(
+        Console& console, path const& obbfile, ObbArchive obb,
+        NameFilter const& filter) -> std::unique_ptr<Archive> {
+    auto archive = std::make_unique<Archive>(obbfile, std::move(obb));
+
+    archive->story          = findStoryFiles(archive->obb);
+    StoryFiles const& story = archive->story;
+    if (story.mainJson) {
+        console.line("Found main json : "sv, story.mainJson->name);
+    }
+    if (story.inkContent) {
+        console.line("Found inkcontent: "sv, story.inkContent->name);
+    }
+
+    // Sort by data order in file, to improve OS prefetching. Unwanted
+    // entries are dropped before anything gets decompressed; the file index
+    // still lists all of them.
+    EntryTable const  table(archive->obb);
+    vector<ObbEntry>& entries  = archive->entries;
+    vector<ObbEntry>& selected = archive->selected;
+    bool const        all      = filter.selectsAll();
+    entries.reserve(table.size());
+    for (uint32_t const index : table.byPosition()) {
+        entries.push_back(table.entry(index));
+        if (all || filter.matches(entries.back().name)) {
+            selected.push_back(entries.back());
+        }
+    }
+
+    archive->referenceName = story.referenceName();
+    if (story.hasReference() && filter.matches(archive->referenceName)) {
+        archive->reference = ObbEntry{
+                archive->referenceName, story.mainJson->data,
+                story.mainJson->fulllength};
+    }
+    archive->inkData = story.inkContent ? story.inkContent->data : ""sv;
+    archive->obbfd   = openForReading(obbfile);
+    return archive;
+}
+
+// Extraction of an archive into a directory: the state its workers share,
+// and what they produce.
+struct DirectoryJob {
+    Archive const& archive;
+    path const     outdir;
+    OutputTree     tree;
+    // Links to the JSON files, for easier browsing; empty if not wanted.
+    optional<OutputTree> links;
+    // Where the links point to: the output directory, as an absolute path.
+    path                         linkTarget;
+    Manifest const               previous;
+    std::unique_ptr<UringWriter> uring;
+    ExtractContext const         context;
+    // One of each per selected entry.
+    vector<uint64_t>                 hashes;
+    vector<optional<ManifestRecord>> records;
+    optional<ManifestRecord>         referenceRecord;
+    // Selected entries which are decoded, along with the reference file if
+    // it is selected, and pairs of the remaining entries with the entry they
+    // are identical to, which they are cloned from.
+    vector<size_t>                    primaries;
+    vector<std::pair<size_t, size_t>> duplicates;
+    // Over the primaries, which are read in order of priority and position,
+    // save for those moved to the front for the memory budget.
+    optional<ReadWindow> window;
+    // What is in the output directory after extraction.
+    Manifest manifest;
+    // Index of the first selected entry in the stats report; the reference
+    // comes after them.
+    size_t firstStats = 0;
+
+    // The output directory, and the link directory if any, must exist.
+    DirectoryJob(
+            Console& console, Archive const& _archive, Target const& target,
+            Options const& options, StatsReport* stats, EventLog* events,
+            CheckpointCollector* checkpoints)
+            : archive(_archive), outdir(target.outdir), tree(target.outdir),
+              previous(loadManifest(target.outdir / ManifestName)),
+              uring(options.ioUring ? UringWriter::create() : nullptr),
+              context{console,
+                      archive.obb,
+                      &tree,
+                      archive.inkData,
+                      archive.obbfd,
+                      previous,
+                      options.force,
+                      uring.get(),
+                      stats,
+                      events,
+                      checkpoints},
+              hashes(archive.selected.size()),
+              records(archive.selected.size()) {
+        if (!target.linkdir.empty()) {
+            links.emplace(target.linkdir);
+            linkTarget = boost::filesystem::absolute(target.outdir);
+        }
+        if (uring && events != nullptr) {
+            uring->onWritten([this](string_view const name) {
+                announce(context, "written"sv, name);
+            });
+        }
+    }
+
+    // Stands for the reference file among the primaries.
+    [[nodiscard]] auto referenceItem() const noexcept -> size_t {
+        return archive.selected.size();
+    }
+    [[nodiscard]] auto itemEntry(size_t index) const -> ObbEntry const& {
+        return index == referenceItem() ? *archive.reference
+                                        : archive.selected[index];
+    }
+};
+
+// Creates the directories for all selected files, and for the links to the
+// JSON files among them.
+void createDirectories(Console& console, DirectoryJob& job) {
+    Archive const& archive = job.archive;
+    vector<path>   outnames;
+    outnames.reserve(archive.selected.size() + 1);
+    for (ObbEntry const& entry : archive.selected) {
+        outnames.push_back(outputName(entry.name));
+    }
+    if (archive.reference) {
+        outnames.push_back(outputName(archive.reference->name));
+    }
+    createDirectories(console, job.tree, outnames);
+    if (job.links) {
+        outnames.erase(
+                std::remove_if(
+                        outnames.begin(), outnames.end(),
+                        [](path const& outname) {
+                            return !isJsonFile(outname);
+                        }),
+                outnames.end());
+        createDirectories(console, *job.links, outnames);
+    }
+}
+
+// Links an extracted JSON file into the link directory.
+void linkFile(DirectoryJob const& job, string_view const name) {
+    path const outname(outputName(name));
+    if (!job.links || !isJsonFile(outname)) {
+        return;
+    }
+    if (!job.links->createSymlink(outname, job.linkTarget / outname)) {
+        job.context.console.error(
+                "Could not create link "sv, job.links->fullPath(outname),
+                "!"sv);
+    }
+}
+
+// Splits the selected entries into those which have to be decoded, and
+// those which are bound to produce the same file as one of them: the same
+// stored bytes, and the same processing. Entries are compared by size first,
+// so only those which might be duplicates are hashed here.
+void findDuplicates(DirectoryJob& job, bool dedup, size_t windowSize) {
+    Archive const&          archive  = job.archive;
+    vector<ObbEntry> const& selected = archive.selected;
+    vector<bool>            isDuplicate(selected.size(), false);
+    if (dedup) {
+        using Shape = std::tuple<size_t, uint32_t, bool>;
+        std::map<Shape, vector<size_t>> candidates;
+        for (size_t ii = 0; ii < selected.size(); ii++) {
+            ObbEntry const& entry = selected[ii];
+            // Empty files are as cheap to create as to link.
+            if (entry.fulllength != 0) {
+                candidates[{entry.data.size(), entry.fulllength,
+                            isJsonFile(outputName(entry.name))}]
+                        .push_back(ii);
+            }
+        }
+        // Candidates are hashed in position order, so that the window keeps
+        // memory use down here too.
+        vector<size_t> toHash;
+        for (auto const& [shape, group] : candidates) {
+            if (group.size() >= 2) {
+                toHash.insert(toHash.end(), group.cbegin(), group.cend());
+            }
+        }
+        std::sort(toHash.begin(), toHash.end());
+        vector<string_view> items;
+        items.reserve(toHash.size());
+        for (size_t const index : toHash) {
+            items.push_back(selected[index].data);
+        }
+        ReadWindow window(
+                archive.obb.contents(), archive.obbfd.get(), windowSize, items);
+        for (size_t ii = 0; ii < toHash.size(); ii++) {
+            window.claim(ii);
+            job.hashes[toHash[ii]] = hashData(items[ii]);
+            window.finish(ii);
+        }
+
+        for (auto const& [shape, group] : candidates) {
+            if (group.size() < 2) {
+                continue;
+            }
+            std::unordered_map<uint64_t, vector<size_t>> byHash;
+            for (size_t const index : group) {
+                string_view const data = selected[index].data;
+                vector<size_t>&   same = byHash[job.hashes[index]];
+                // Different data can have the same hash.
+                auto const primary = std::find_if(
+                        same.cbegin(), same.cend(), [&](size_t const other) {
+                            return selected[other].data == data;
+                        });
+                if (primary == same.cend()) {
+                    same.push_back(index);
+                } else {
+                    job.duplicates.emplace_back(index, *primary);
+                    isDuplicate[index] = true;
+                }
+            }
+        }
+    }
+    for (size_t ii = 0; ii < selected.size(); ii++) {
+        if (!isDuplicate[ii]) {
+            job.primaries.push_back(ii);
+        }
+    }
+}
+
+[[nodiscard]] auto itemPriority(DirectoryJob const& job, size_t index)
+        -> Priority {
+    return priorityOf(
+            job.archive.story, job.itemEntry(index),
+            index == job.referenceItem());
+}
+
+[[nodiscard]] auto itemFootprint(DirectoryJob const& job, size_t index)
+        -> size_t {
+    return footprintOf(
+            job.context, job.itemEntry(index), index == job.referenceItem());
+}
+
+// Adds the reference file to the primaries, first among the story files,
+// and puts them in the order they are extracted in.
+void scheduleJob(
+        DirectoryJob& job, MemoryBudget const& budget, unsigned numThreads) {
+    if (job.archive.reference) {
+        job.primaries.insert(job.primaries.begin(), job.referenceItem());
+    }
+    scheduleEntries(
+            job.primaries, budget, numThreads,
+            [&](size_t const index) { return itemPriority(job, index); },
+            [&](size_t const index) { return itemFootprint(job, index); });
+}
+
+void openWindow(DirectoryJob& job, size_t windowSize) {
+    Archive const&      archive = job.archive;
+    vector<string_view> items;
+    items.reserve(job.primaries.size());
+    for (size_t const index : job.primaries) {
+        items.push_back(job.itemEntry(index).data);
+    }
+    job.window.emplace(
+            archive.obb.contents(), archive.obbfd.get(), windowSize, items);
+}
+
+// Extracts a selected entry, unless it is up to date.
+void extractFile(DirectoryJob& job, zlib_decompressor& unzip, size_t index) {
+    Stopwatch const       timer;
+    ExtractContext const& context = job.context;
+    ObbEntry const&       entry   = job.archive.selected[index];
+    job.hashes[index]             = hashData(entry.data);
+    job.records[index]
+            = updateFile(context, unzip, entry, job.hashes[index], false);
+    if (job.records[index]) {
+        linkFile(job, entry.name);
+    }
+    recordStats(context, job.firstStats + index, entry, timer);
+}
+
+// Makes a selected entry a clone of the file extracted for the entry it is
+// identical to, unless it is up to date. If that file is missing or cannot
+// be cloned, the entry is extracted on its own.
+void extractDuplicate(
+        DirectoryJob& job, zlib_decompressor& unzip, size_t index,
+        size_t primary) {
+    Stopwatch const         timer;
+    ExtractContext const&   context  = job.context;
+    vector<ObbEntry> const& selected = job.archive.selected;
+    ObbEntry const&         entry    = selected[index];
+    path const              outname(outputName(entry.name));
+    optional<ManifestRecord>& record = job.records[index];
+    record = sourceRecord(context, entry, job.hashes[index]);
+    if (!job.tree.hasDirectory(outname.parent_path())) {
+        record.reset();
+        announce(context, "failed"sv, entry.name);
+    } else if (auto const current
+               = findUpToDate(context, entry, outname, *record)) {
+        record = current;
+        announce(context, "unchanged"sv, entry.name);
+    } else if (
+            job.records[primary]
+            && job.tree.cloneFile(
+                    outputName(selected[primary].name), outname)) {
+        context.console.progress("Linking file "sv, entry.name);
+        record->outputSize = job.records[primary]->outputSize;
+        record->outputHash = job.records[primary]->outputHash;
+        announce(context, "linked"sv, entry.name);
+    } else {
+        record = updateFile(context, unzip, entry, job.hashes[index], false);
+    }
+    if (record) {
+        linkFile(job, entry.name);
+    }
+    recordStats(context, job.firstStats + index, entry, timer);
+}
+
+// Waits for files still being written, and drops the records of those which
+// could not be written.
+void finishWrites(DirectoryJob& job) {
+    ExtractContext const&   context  = job.context;
+    vector<ObbEntry> const& selected = job.archive.selected;
+    if (context.uring == nullptr) {
+        return;
+    }
+    std::set<string_view> failed;
+    for (string_view const name : context.uring->finish()) {
+        path const outname(outputName(name));
+        context.console.error(
+                "Could not write file "sv, job.tree.fullPath(outname), "!"sv);
+        job.tree.removeFile(outname);
+        if (job.links) {
+            job.links->removeFile(outname);
+        }
+        announce(context, "failed"sv, name);
+        failed.insert(name);
+    }
+    for (size_t ii = 0; ii < selected.size(); ii++) {
+        if (failed.count(selected[ii].name) != 0) {
+            job.records[ii].reset();
+        }
+    }
+}
+
+// Collects what the output directory now holds.
+void collectRecords(DirectoryJob& job) {
+    ExtractContext const&   context  = job.context;
+    vector<ObbEntry> const& selected = job.archive.selected;
+    // Records of files which were not selected this time are kept, as long
+    // as the files are still in the OBB.
+    optional<ObbEntry> const& reference = job.archive.reference;
+    for (auto const& [name, record] : job.previous) {
+        if ((reference && name == reference->name) || context.obb.find(name)) {
+            job.manifest.emplace(name, record);
+        }
+    }
+    for (size_t ii = 0; ii < selected.size(); ii++) {
+        job.manifest.erase(string(selected[ii].name));
+        if (job.records[ii]) {
+            job.manifest.emplace(string(selected[ii].name), *job.records[ii]);
+        }
+    }
+    if (reference) {
+        job.manifest.erase(string(reference->name));
+        if (job.referenceRecord) {
+            job.manifest.emplace(string(reference->name), *job.referenceRecord);
+        }
+    }
+}
+
+// The reference only needs to be rebuilt if either of its sources changed.
+void extractReference(DirectoryJob& job, zlib_decompressor& unzip) {
+    Stopwatch const       timer;
+    ExtractContext const& context   = job.context;
+    ObbEntry const&       reference = *job.archive.reference;
+    uint64_t const        storedHash
+            = hashData(reference.data, hashData(context.inkData));
+    job.referenceRecord
+            = updateFile(context, unzip, reference, storedHash, true);
+    if (job.referenceRecord) {
+        linkFile(job, reference.name);
+    }
+    recordStats(
+            context, job.firstStats + job.referenceItem(), reference, timer);
+}
+
+void writeManifest(DirectoryJob const& job) {
+    path const manifestFile(job.tree.fullPath(ManifestName));
+    if (!writeFileIfChanged(manifestFile, formatManifest(job.manifest))) {
+        job.context.console.error(
+                "Could not write file "sv, manifestFile, "!"sv);
+    }
+}
+
+// Saves the file table for future reference.
+void writeFileTable(DirectoryJob const& job) {
+    Archive const& archive = job.archive;
+    path const     tableFile(job.tree.fullPath(FileTableName));
+    if (!writeFileIfChanged(
+                tableFile, formatFileIndex(
+                                   archive.obb, archive.entries,
+                                   archive.selected, job.hashes))) {
+        job.context.console.error("Could not write file "sv, tableFile, "!"sv);
+    }
+}
+
+// Runs work on the items of all jobs with one set of workers; countOf says
+// how many items a job has. Items are numbered across jobs, one job after
+// the other.
+template <typename Count, typename Work>
+void forEachItem(
+        vector<std::unique_ptr<DirectoryJob>> const& jobs,
+        unsigned numThreads, Count const& countOf, Work const& work) {
+    vector<size_t> firstItem;
+    size_t         count = 0;
+    for (auto const& job : jobs) {
+        firstItem.push_back(count);
+        count += countOf(*job);
+    }
+    extractEntries(
+            count, numThreads, [&](zlib_decompressor& unzip, size_t index) {
+                auto const next = std::upper_bound(
+                        firstItem.cbegin(), firstItem.cend(), index);
+                auto const which = static_cast<size_t>(
+                        std::distance(firstItem.cbegin(), next) - 1);
+                work(*jobs[which], unzip, index - firstItem[which]);
+            });
+}
+
+// Files queued for io_uring keep their buffers after the lease of their entry
+// ends, until they are written. Each writer gets a share of up to a quarter of
+// the budget for them, which it keeps its buffers within; that much is set
+// aside from the budget. Only when a writer has no buffers in flight does it
+// take one larger than its share, which the entry's lease covered.
+void setAsideUringBuffers(
+        vector<std::unique_ptr<DirectoryJob>> const& jobs,
+        MemoryBudget& budget) {
+    auto const writers = static_cast<size_t>(std::count_if(
+            jobs.cbegin(), jobs.cend(),
+            [](auto const& job) { return job->uring != nullptr; }));
+    if (!budget.enabled() || writers == 0) {
+        return;
+    }
+    size_t const share = std::min(
+            size_t{UringWriter::QueueDepth} * UringWriter::MaxFileSize,
+            budget.capacity() / 4U / writers);
+    for (auto const& job : jobs) {
+        if (job->uring) {
+            job->uring->limitBuffers(share);
+        }
+    }
+    budget.setAside(share * writers);
+}
+
+// Extracts the selected entries of all archives with one set of workers, so
+// that no thread sits idle between archives, and then finishes each of the
+// output directories.
+void extractToDirectories(
+        vector<std::unique_ptr<DirectoryJob>> const& jobs,
+        unsigned numThreads, MemoryBudget& budget, StatsReport* stats) {
+    Stopwatch  phase;
+    auto const endPhase = [&](string_view const name) {
+        double const seconds = phase.lap();
+        if (stats != nullptr) {
+            stats->addPhase(name, seconds);
+        }
+    };
+
+    // The primaries of all jobs, scheduled together so that each class of
+    // files is done for all of them before the next, and the large entries of
+    // every job start first; each job's keep their order otherwise.
+    vector<std::pair<DirectoryJob*, size_t>> items;
+    for (auto const& job : jobs) {
+        job->firstStats = reserveStats(
+                job->context,
+                job->records.size() + (job->archive.reference ? 1U : 0U));
+        for (size_t ii = 0; ii < job->primaries.size(); ii++) {
+            items.emplace_back(job.get(), ii);
+        }
+    }
+    vector<size_t> order(items.size());
+    std::iota(order.begin(), order.end(), size_t{0U});
+    scheduleEntries(
+            order, budget, numThreads,
+            [&](size_t const item) {
+                auto const& [job, ii] = items[item];
+                return itemPriority(*job, job->primaries[ii]);
+            },
+            [&](size_t const item) {
+                auto const& [job, ii] = items[item];
+                return itemFootprint(*job, job->primaries[ii]);
+            });
+    // Duplicates are cloned once everything they are cloned from has been
+    // written; they hardly take any memory.
+    extractEntries(
+            items.size(), numThreads,
+            [&](zlib_decompressor& unzip, size_t const item) {
+                auto const [job, ii] = items[order[item]];
+                size_t const index   = job->primaries[ii];
+                MemoryBudget::Lease lease(budget, itemFootprint(*job, index));
+                job->window->claim(ii);
+                if (index == job->referenceItem()) {
+                    extractReference(*job, unzip);
+                } else {
+                    extractFile(*job, unzip, index);
+                }
+                job->window->finish(ii);
+            });
+    for (auto const& job : jobs) {
+        finishWrites(*job);
+    }
+    forEachItem(
+            jobs, numThreads,
+            [](DirectoryJob const& job) { return job.duplicates.size(); },
+            [](DirectoryJob& job, zlib_decompressor& unzip, size_t index) {
+                auto const [duplicate, primary] = job.duplicates[index];
+                extractDuplicate(job, unzip, duplicate, primary);
+            });
+    for (auto const& job : jobs) {
+        finishWrites(*job);
+        collectRecords(*job);
+    }
+    endPhase("extraction"sv);
+
+    for (auto const& job : jobs) {
+        writeManifest(*job);
+    }
+    endPhase("manifest"sv);
+
+    for (auto const& job : jobs) {
+        writeFileTable(*job);
+        if (job->context.events != nullptr) {
+            job->context.events->done(job->archive.obbfile, job->outdir);
+        }
+    }
+    endPhase("file_table"sv);
 }
 
 extern "C" auto main(int argc, char* argv[]) -> int;
 
 auto main(int argc, char* argv[]) -> int {
     try {
-        if (argc != 3) {
-            cerr << "Usage: "sv << argv[0] << " inputfile outputdir"sv << endl
-                 << endl;
-            return eWRONG_ARGC;
+        Options const options = parseArguments(argc, argv);
+        if (options.codec) {
+            setCodecBackend(*options.codec);
+        }
+        optional<StatsReport> stats;
+        if (!options.statsfile.empty()) {
+            stats.emplace("xtractobb"s);
+        }
+        Stopwatch  phase;
+        auto const endPhase = [&](string_view const name) {
+            double const seconds = phase.lap();
+            if (stats) {
+                stats->addPhase(name, seconds);
+            }
+        };
+        vector<ObbArchive> obbs;
+        obbs.reserve(options.targets.size());
+        for (Target const& target : options.targets) {
+            obbs.push_back(readObbFile(target.obbfile));
         }
+        endPhase("mmap"sv);
 
-        path const         obbfile(argv[1]);
-        mapped_file_source obbcontents = readObbFile(obbfile);
+        if (options.diff) {
+            cout << formatDiff(
+                    diffArchives(
+                            obbs[0], obbs[1], options.filter,
+                            options.numThreads),
+                    options.listFormat);
+            return eOK;
+        }
 
-        path const outdir(argv[2]);
-        createOutputDir(outdir);
+        if (!options.stitch.empty()) {
+            StoryFiles const story = findStoryFiles(obbs.front());
+            InflateIndex     index;
+            vector<InflateCheckpoint> const* inkCheckpoints = nullptr;
+            if (!options.inflateIndex.empty() && story.inkContent) {
+                index = loadInflateIndex(
+                        path(options.inflateIndex), obbs.front());
+                inkCheckpoints = index.find(obbs.front(), *story.inkContent);
+            }
+            optional<string> const stitch
+                    = readStitch(story, options.stitch, inkCheckpoints);
+            if (!stitch) {
+                cerr << "Stitch '"sv << options.stitch << "' not found!"sv
+                     << endl
+                     << endl;
+                throw ErrorCodes{eINVALID_ARGS};
+            }
+            cout << *stitch;
+            return eOK;
+        }
 
-        string_view const oggview(obbcontents.data(), obbcontents.size());
-        uint32_t const    hlen = Read4(oggview.cbegin() + 8);
-        uint32_t const    htbl = Read4(oggview.cbegin() + 12);
-        if (obbcontents.size() != hlen) {
-            cerr << "Incorrect length in header!"sv << endl << endl;
-            return eOBB_CORRUPT;
+        if (options.list) {
+            cout << formatListing(
+                    obbs.front(), options.filter, options.listOrder,
+                    options.reverse, options.listFormat);
+            return eOK;
         }
 
-        // TODO: Main json file should be found from Info.plist file:
-        //  main json filename = dict["StoryFilename"sv] + ".json"
-        regex const mainJsonRegex(R"regex(Sorcery\d\.(min)?json)regex"s);
-        // TODO: inkcontent filename should be found from main json:
-        // inkcontent filename = indexed-content/filename
-        regex const inkContentRegex(R"regex(Sorcery\d\.inkcontent)regex"s);
-
-        XFile_entry         mainJson;
-        XFile_entry         inkContent;
-        vector<XFile_entry> entries;
-        entries.reserve((oggview.size() - htbl) / XFile_entry::EntrySize);
-
-        for (const auto* it = oggview.cbegin() + htbl; it != oggview.cend();
-             it += XFile_entry::EntrySize) {
-            entries.emplace_back(it, oggview);
-            // TODO: These should be obtained by name from OBB wrapper when
-            // class is implemented.
-            string_view fname = entries.back().name();
-            if (regex_match(fname.cbegin(), fname.cend(), mainJsonRegex)) {
-                mainJson = entries.back();
-                cout << "\33[2K\rFound main json : "sv << fname << endl;
-            } else if (regex_match(
-                               fname.cbegin(), fname.cend(), inkContentRegex)) {
-                inkContent = entries.back();
-                cout << "\33[2K\rFound inkcontent: "sv << fname << endl;
+        std::unique_ptr<CheckpointCollector> checkpoints;
+        path const indexfile(options.inflateIndex);
+        if (!options.inflateIndex.empty()) {
+            checkpoints = std::make_unique<CheckpointCollector>(
+                    loadInflateIndex(indexfile, obbs.front()));
+        }
+        // Runs at the end of extraction or verification.
+        auto const writeInflateIndex = [&](Console& console) {
+            if (!checkpoints) {
+                return;
+            }
+            ofstream fout(indexfile, ios::out | ios::binary);
+            fout << checkpoints->format();
+            if (!fout.good()) {
+                console.error("Could not write file "sv, indexfile, "!"sv);
+            }
+        };
+
+        if (options.verify) {
+            Console        console(cout);
+            UniqueFd const obbfd
+                    = openForReading(options.targets.front().obbfile);
+            if (!verifyArchive(
+                        console, obbs.front(), obbfd, options.numThreads,
+                        options.windowSize, checkpoints.get())) {
+                return eOBB_CORRUPT;
             }
+            writeInflateIndex(console);
+            return eOK;
         }
 
-        // Sort by data order in file, to improve OS prefetching.
-        sort(entries.begin(), entries.end(), [](auto& lhs, auto& rhs) {
-            return lhs.file().data() < rhs.file().data();
-        });
-        {
-            // Save file table for future reference.
-            ofstream      file_table(outdir / "FileTable.ser");
-            text_oarchive archive(file_table);
-            archive << entries;
+        bool const toTar    = !options.tarfile.empty();
+        bool const toStdout = options.tarfile == "-"sv;
+        Console    console(toStdout ? cerr : cout);
+
+        std::unique_ptr<ofstream> tarfile;
+        if (toStdout) {
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            std::ios::sync_with_stdio(false);
+        } else if (toTar) {
+            tarfile = std::make_unique<ofstream>(
+                    path(options.tarfile), ios::out | ios::binary);
+            if (!tarfile->good()) {
+                cerr << "Could not create file "sv << options.tarfile << "!"sv
+                     << endl
+                     << endl;
+                throw ErrorCodes{eOUTPUT_NO_ACCESS};
+            }
+        } else {
+            for (Target const& target : options.targets) {
+                createOutputDir(target.outdir);
+                if (!target.linkdir.empty()) {
+                    createOutputDir(target.linkdir);
+                }
+            }
         }
 
-        zlib_decompressor unzip(
-                zlib::default_window_bits, 1ULL * 1024ULL * 1024ULL);
+        MemoryBudget budget(options.maxMemory);
 
-        for (auto& elem : entries) {
-            cout << "\33[2K\rExtracting file "sv << elem.name() << flush;
+        std::unique_ptr<EventLog> events;
+        if (!options.events.empty()) {
+            events = EventLog::open(options.events);
+            if (!events) {
+                cerr << "Could not open event stream "sv << options.events
+                     << "!"sv << endl
+                     << endl;
+                throw ErrorCodes{eOUTPUT_NO_ACCESS};
+            }
+        }
 
-            path outfile(outdir / elem.name());
-            decodeFile(
-                    unzip, outfile, elem.file(), inkContent.file(),
-                    elem.compressed, false);
+        vector<std::unique_ptr<Archive>> archives;
+        for (size_t ii = 0; ii < obbs.size(); ii++) {
+            archives.push_back(loadArchive(
+                    console, options.targets[ii].obbfile, std::move(obbs[ii]),
+                    options.filter));
         }
 
-        if (!mainJson.file().empty() && !inkContent.file().empty()) {
-            string const fname = mainJson.name().substr(0, "SorceryN"sv.size())
-                                 + "-Reference.json"s;
-            path const outfile(outdir / fname);
-            decodeFile(
-                    unzip, outfile, mainJson.file(), inkContent.file(),
-                    mainJson.compressed, true);
+        if (toTar) {
+            Archive const& archive = *archives.front();
+            // Members use the OBB's timestamp, so with a single thread the tar
+            // stream only depends on the OBB contents. With more, members are
+            // added in the order they are done.
+            TarWriter tar(
+                    toStdout ? cout : *tarfile,
+                    last_write_time(archive.obbfile));
+            Manifest const       none;
+            ExtractContext const context{
+                    console,
+                    archive.obb,
+                    nullptr,
+                    archive.inkData,
+                    archive.obbfd,
+                    none,
+                    true,
+                    nullptr,
+                    stats ? &*stats : nullptr,
+                    nullptr,
+                    checkpoints.get()};
+            endPhase("table_parse"sv);
+            vector<uint64_t> const hashes = extractToTar(
+                    context, tar, archive.selected, archive.reference,
+                    archive.story, options.numThreads, options.windowSize,
+                    budget);
+            phase.lap();
+            tar.addFile(
+                    FileTableName,
+                    formatFileIndex(
+                            archive.obb, archive.entries, archive.selected,
+                            hashes));
+            if (!tar.finish()) {
+                console.error(
+                        "Could not write tar archive "sv,
+                        toStdout ? "to stdout"s : options.tarfile, "!"sv);
+                throw ErrorCodes{eOUTPUT_NO_ACCESS};
+            }
+            endPhase("file_table"sv);
+        } else {
+            vector<std::unique_ptr<DirectoryJob>> jobs;
+            for (size_t ii = 0; ii < archives.size(); ii++) {
+                jobs.push_back(std::make_unique<DirectoryJob>(
+                        console, *archives[ii], options.targets[ii], options,
+                        stats ? &*stats : nullptr, events.get(),
+                        checkpoints.get()));
+                createDirectories(console, *jobs.back());
+                findDuplicates(
+                        *jobs.back(), options.dedup, options.windowSize);
+            }
+            // The budget must be final before the entries are scheduled.
+            setAsideUringBuffers(jobs, budget);
+            for (auto const& job : jobs) {
+                scheduleJob(*job, budget, options.numThreads);
+                openWindow(*job, options.windowSize);
+            }
+            // Small files go through io_uring when asked to and supported.
+            if (options.ioUring && !jobs.front()->uring) {
+                console.line(
+                        "io_uring is not available; writing files directly."sv);
+            }
+            endPhase("table_parse"sv);
+            extractToDirectories(
+                    jobs, options.numThreads, budget,
+                    stats ? &*stats : nullptr);
+        }
+        writeInflateIndex(console);
+        console.append('\n');
+        if (stats) {
+            path const statsfile(options.statsfile);
+            ofstream   fout(statsfile, ios::out | ios::binary);
+            fout << stats->format();
+            if (!fout.good()) {
+                console.error("Could not write file "sv, statsfile, "!"sv);
+            }
         }
-        cout << endl;
+    } catch (bad_obb const& except) {
+        cerr << endl << except.what() << endl;
+        return eOBB_CORRUPT;
     } catch (exception const& except) {
         cerr << except.what() << endl;
     } catch (ErrorCodes err) {